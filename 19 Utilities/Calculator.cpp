@@ -1,163 +1,1333 @@
 #include <iostream>
-#include <stack>
 #include <string>
 #include <map>
 #include <vector>
-#include <sstream>
 #include <cmath>
+#include <charconv>
+#include <cstdint>
 #include <stdexcept>
 #include <cctype>
-#include <regex>
+#include <chrono>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <unordered_map>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <string_view>
+#include <filesystem>
 
-class Calculator {
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Operations of expression tree nodes and bytecode instructions
+enum class ExprOp : unsigned char {
+    Push, Load, Prev,   // Constant, variable, stored result
+    Fetch, Store,       // Bytecode only: reuse a saved common subexpression
+    Neg, Sin, Sqrt,     // Unary
+    Add, Sub, Mul, Div, Pow, Min, Max  // Binary
+};
+
+// Parsed expression. Nodes are stored in a flat array with children before their parents.
+// The parser produces a tree in postorder; after optimization nodes may be shared (a DAG).
+struct ExprTree {
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        ExprOp op;
+        uint32_t lhs, rhs;  // Operands (NONE if unused)
+        size_t slot;        // Variable for Load, result index for Prev
+        double value;       // Constant for Push
+    };
+
+    std::vector<Node> nodes;
+    std::vector<std::string> names;  // Variable names by slot
+    uint32_t root = NONE;
+};
+
+// Single-pass tokenizer and Pratt (precedence climbing) parser. Numbers are read with
+// std::from_chars; the tree is built as the tokens are consumed.
+//   expression := prefix (binary-op expression)*
+//   prefix     := number | name | name '(' arguments ')' | '(' expression ')' | ('-' | '+') prefix
+// Binary operators are + - (lowest), * /, then ^ (right-associative); unary minus binds
+// tighter than * but looser than ^, so -2^2 is -4 and 2^-1 is 0.5.
+class ExprParser {
 private:
-    std::vector<double> previousResults;  // Stores previous results
+    static constexpr size_t MAX_NESTING = 256;
+
+    enum class Token { Number, Name, Operator, LeftParen, RightParen, Comma, End };
+
+    const std::string& text;
+    size_t historySize;  // Number of stored results prev() may refer to
+    size_t pos = 0;      // Next character to tokenize
+    size_t nesting = 0;
+    ExprTree tree;
+
+    // Current token
+    Token token = Token::End;
+    size_t tokenStart = 0, tokenLength = 0;
+    double number = 0;
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("Invalid expression: " + what + " at position " + std::to_string(tokenStart + 1));
+    }
+
+    std::string tokenText() const {
+        return token == Token::End ? "end of input" : "'" + text.substr(tokenStart, tokenLength) + "'";
+    }
+
+    void advance() {
+        while (pos < text.length() && isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+        tokenStart = pos;
+        if (pos == text.length()) {
+            token = Token::End;
+            tokenLength = 0;
+            return;
+        }
+        char c = text[pos];
+        if (isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            const char* first = text.data() + pos;
+            std::from_chars_result parsed = std::from_chars(first, text.data() + text.length(), number);
+            if (parsed.ec == std::errc::invalid_argument) {
+                tokenLength = 1;
+                fail("malformed number");
+            }
+            tokenLength = parsed.ptr - first;
+            if (parsed.ec == std::errc::result_out_of_range) fail("number out of range");
+            token = Token::Number;
+        } else if (isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t end = pos + 1;
+            while (end < text.length() && (isalnum(static_cast<unsigned char>(text[end])) || text[end] == '_')) ++end;
+            token = Token::Name;
+            tokenLength = end - pos;
+        } else {
+            tokenLength = 1;
+            switch (c) {
+                case '+': case '-': case '*': case '/': case '^': token = Token::Operator; break;
+                case '(': token = Token::LeftParen; break;
+                case ')': token = Token::RightParen; break;
+                case ',': token = Token::Comma; break;
+                default: fail("unexpected '" + std::string(1, c) + "'");
+            }
+        }
+        pos += tokenLength;
+    }
+
+    void expect(Token kind, const char* what) {
+        if (token != kind) fail(std::string("expected ") + what + ", found " + tokenText());
+        advance();
+    }
+
+    uint32_t add(ExprOp op, uint32_t lhs = ExprTree::NONE, uint32_t rhs = ExprTree::NONE, size_t slot = 0, double value = 0) {
+        tree.nodes.push_back({op, lhs, rhs, slot, value});
+        return static_cast<uint32_t>(tree.nodes.size() - 1);
+    }
+
+    // Binding powers of the binary operator c: left (how tightly it holds the operand before
+    // it) and right (the minimum power of operators allowed in the operand after it)
+    static bool binaryPower(char c, int& left, int& right, ExprOp& op) {
+        switch (c) {
+            case '+': left = 10; right = 11; op = ExprOp::Add; return true;
+            case '-': left = 10; right = 11; op = ExprOp::Sub; return true;
+            case '*': left = 20; right = 21; op = ExprOp::Mul; return true;
+            case '/': left = 20; right = 21; op = ExprOp::Div; return true;
+            case '^': left = 40; right = 40; op = ExprOp::Pow; return true;  // Right-associative
+        }
+        return false;
+    }
+
+    static constexpr int UNARY_POWER = 30;
+
+    uint32_t parseExpression(int minPower) {
+        if (++nesting > MAX_NESTING) throw std::runtime_error("Expression too deeply nested");
+        uint32_t lhs = parsePrefix();
+        int left, right;
+        ExprOp op;
+        while (token == Token::Operator && binaryPower(text[tokenStart], left, right, op) && left >= minPower) {
+            advance();
+            uint32_t rhs = parseExpression(right);
+            lhs = add(op, lhs, rhs);
+        }
+        --nesting;
+        return lhs;
+    }
+
+    uint32_t parsePrefix() {
+        switch (token) {
+            case Token::Number: {
+                double value = number;
+                advance();
+                return add(ExprOp::Push, ExprTree::NONE, ExprTree::NONE, 0, value);
+            }
+            case Token::Name: {
+                std::string name = text.substr(tokenStart, tokenLength);
+                size_t nameStart = tokenStart;
+                advance();
+                if (token == Token::LeftParen) return parseCall(name, nameStart);
+                size_t slot = std::find(tree.names.begin(), tree.names.end(), name) - tree.names.begin();
+                if (slot == tree.names.size()) tree.names.push_back(name);
+                return add(ExprOp::Load, ExprTree::NONE, ExprTree::NONE, slot);
+            }
+            case Token::LeftParen: {
+                advance();
+                uint32_t inner = parseExpression(0);
+                expect(Token::RightParen, "')'");
+                return inner;
+            }
+            case Token::Operator:
+                if (text[tokenStart] == '-' || text[tokenStart] == '+') {
+                    bool negate = text[tokenStart] == '-';
+                    advance();
+                    uint32_t operand = parseExpression(UNARY_POWER);
+                    return negate ? add(ExprOp::Neg, operand) : operand;
+                }
+                break;
+            default:
+                break;
+        }
+        fail("unexpected " + tokenText());
+    }
+
+    // name '(' arguments ')', with the current token at '('
+    uint32_t parseCall(const std::string& name, size_t nameStart) {
+        advance();
+        if (name == "prev") {
+            // prev(index): reference to a stored result (1-based)
+            double index = number;
+            if (token != Token::Number || index != std::floor(index)) fail("expected a result number");
+            if (index < 1 || index > historySize) throw std::out_of_range("Invalid 'prev(index)' value");
+            advance();
+            expect(Token::RightParen, "')'");
+            return add(ExprOp::Prev, ExprTree::NONE, ExprTree::NONE, static_cast<size_t>(index) - 1);
+        }
+
+        ExprOp op;
+        size_t minArgs = 1, maxArgs = 1;
+        if (name == "sin") op = ExprOp::Sin;
+        else if (name == "sqrt") op = ExprOp::Sqrt;
+        else if (name == "min") op = ExprOp::Min, minArgs = 2, maxArgs = SIZE_MAX;
+        else if (name == "max") op = ExprOp::Max, minArgs = 2, maxArgs = SIZE_MAX;
+        else {
+            tokenStart = nameStart;
+            tokenLength = name.length();
+            fail("unknown function '" + name + "'");
+        }
+
+        // Extra arguments of min/max fold left, keeping the nodes in postorder
+        uint32_t result = parseExpression(0);
+        size_t args = 1;
+        while (token == Token::Comma) {
+            advance();
+            uint32_t next = parseExpression(0);
+            result = add(op, result, next);
+            ++args;
+        }
+        if (args < minArgs || args > maxArgs) {
+            tokenStart = nameStart;
+            fail(name + "() takes " + (maxArgs == 1 ? "one argument" : "at least two arguments"));
+        }
+        expect(Token::RightParen, "')'");
+        return maxArgs == 1 ? add(op, result) : result;
+    }
 
-    // Helper function to return precedence of operators
-    int precedence(char op) {
-        if (op == '+' || op == '-') return 1;
-        if (op == '*' || op == '/') return 2;
-        if (op == '^') return 3;
-        return 0;
+public:
+    ExprParser(const std::string& expression, size_t storedResults) : text(expression), historySize(storedResults) {}
+
+    ExprTree parse() {
+        tree.nodes.reserve(text.length() / 2 + 1);  // Roughly one node per two characters
+        advance();
+        if (token == Token::End) fail("empty expression");
+        tree.root = parseExpression(0);
+        if (token != Token::End) fail("unexpected " + tokenText());
+        return std::move(tree);
     }
+};
+
+// Simplifies a parsed expression. Results are unchanged for every input, except that x^2
+// becomes x*x, which is the correctly rounded square (pow may differ in the last bit).
+// - constant folding (except division by zero, which must still fail when evaluated)
+// - strength reduction: x^2 -> x*x, x^1 -> x, x^0 -> 1 (unless evaluating x can throw),
+//   and x/c -> x*(1/c) when 1/c is exact (c a power of two; other reciprocals round
+//   differently)
+// - identities: x*1, 1*x, x/1, x-0 and --x -> x
+// - dead branches: min/max with identical operands -> the operand
+// - common subexpression elimination: identical nodes are shared (hash-consing)
+// Nodes that no longer contribute to the result are dropped.
+class ExprOptimizer {
+private:
+    using Node = ExprTree::Node;
+    using Key = std::tuple<ExprOp, uint32_t, uint32_t, size_t, uint64_t>;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t h = static_cast<uint64_t>(std::get<0>(key));
+            h = h * 0x9E3779B97F4A7C15ull ^ std::get<1>(key);
+            h = h * 0x9E3779B97F4A7C15ull ^ std::get<2>(key);
+            h = h * 0x9E3779B97F4A7C15ull ^ std::get<3>(key);
+            h = h * 0x9E3779B97F4A7C15ull ^ std::get<4>(key);
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    ExprTree out;
+    std::unordered_map<Key, uint32_t, KeyHash> existing;
+    std::vector<bool> mayThrow;  // Per node: evaluating it can throw (division by zero, evicted prev)
 
-    // Helper function to apply an operator to two numbers
-    double applyOp(double a, double b, char op) {
+    static double apply(ExprOp op, double a, double b) {
         switch (op) {
-            case '+': return a + b;
-            case '-': return a - b;
-            case '*': return a * b;
-            case '/': 
-                if (b == 0) throw std::runtime_error("Division by zero!");
-                return a / b;
-            case '^': return pow(a, b);
+            case ExprOp::Neg: return -a;
+            case ExprOp::Sin: return sin(a);
+            case ExprOp::Sqrt: return sqrt(a);
+            case ExprOp::Add: return a + b;
+            case ExprOp::Sub: return a - b;
+            case ExprOp::Mul: return a * b;
+            case ExprOp::Div: return a / b;
+            case ExprOp::Pow: return pow(a, b);
+            case ExprOp::Min: return std::min(a, b);
+            case ExprOp::Max: return std::max(a, b);
+            default: return 0;
+        }
+    }
+
+    // Add a node, or return an identical one added before
+    uint32_t intern(const Node& node) {
+        uint64_t bits;
+        std::memcpy(&bits, &node.value, sizeof(bits));
+        Key key(node.op, node.lhs, node.rhs, node.slot, bits);
+        auto found = existing.find(key);
+        if (found != existing.end()) return found->second;
+        out.nodes.push_back(node);
+        uint32_t id = static_cast<uint32_t>(out.nodes.size() - 1);
+        existing.emplace(key, id);
+        bool divides = node.op == ExprOp::Div && !(out.nodes[node.rhs].op == ExprOp::Push && out.nodes[node.rhs].value != 0);
+        bool readsHistory = node.op == ExprOp::Prev;  // Throws once the result is evicted
+        mayThrow.push_back(divides || readsHistory || (node.lhs != ExprTree::NONE && mayThrow[node.lhs]) ||
+                           (node.rhs != ExprTree::NONE && mayThrow[node.rhs]));
+        return id;
+    }
+
+    uint32_t constant(double value) {
+        return intern({ExprOp::Push, ExprTree::NONE, ExprTree::NONE, 0, value});
+    }
+
+    uint32_t binary(ExprOp op, uint32_t lhs, uint32_t rhs) {
+        return intern({op, lhs, rhs, 0, 0.0});
+    }
+
+    // True if 1/c is exact, so that x/c == x*(1/c) for every x
+    static bool exactReciprocal(double c) {
+        int exponent;
+        return std::isfinite(c) && std::fabs(std::frexp(c, &exponent)) == 0.5 && std::isnormal(1 / c);
+    }
+
+    // Simplify a node whose operands are already simplified
+    uint32_t simplify(const Node& node) {
+        bool unary = node.op >= ExprOp::Neg && node.op < ExprOp::Add;
+        bool binary = node.op >= ExprOp::Add;
+        if (!unary && !binary) return intern(node);
+        Node a = out.nodes[node.lhs];
+        Node b = binary ? out.nodes[node.rhs] : Node{ExprOp::Push, ExprTree::NONE, ExprTree::NONE, 0, 0.0};
+        bool constA = a.op == ExprOp::Push, constB = b.op == ExprOp::Push;
+
+        if (constA && (unary || (constB && !(node.op == ExprOp::Div && b.value == 0)))) {
+            return constant(apply(node.op, a.value, b.value));
         }
-        return 0;
+        switch (node.op) {
+            case ExprOp::Neg:
+                if (a.op == ExprOp::Neg) return a.lhs;
+                break;
+            case ExprOp::Pow:
+                if (constB && b.value == 1) return node.lhs;
+                if (constB && b.value == 0 && !mayThrow[node.lhs]) return constant(1);
+                if (constB && b.value == 2) return this->binary(ExprOp::Mul, node.lhs, node.lhs);
+                break;
+            case ExprOp::Mul:
+                if (constB && b.value == 1) return node.lhs;
+                if (constA && a.value == 1) return node.rhs;
+                break;
+            case ExprOp::Div:
+                if (constB && b.value == 1) return node.lhs;
+                if (constB && exactReciprocal(b.value)) return this->binary(ExprOp::Mul, node.lhs, constant(1 / b.value));
+                break;
+            case ExprOp::Sub:
+                if (constB && b.value == 0 && !std::signbit(b.value)) return node.lhs;
+                break;
+            case ExprOp::Min:
+            case ExprOp::Max:
+                if (node.lhs == node.rhs) return node.lhs;
+                break;
+            default:
+                break;
+        }
+        return intern(node);
     }
 
-    // Function to check if a character is an operator
-    bool isOperator(char c) {
-        return c == '+' || c == '-' || c == '*' || c == '/' || c == '^';
+    // Keep only the nodes reachable from the root, preserving their order
+    void compact() {
+        std::vector<bool> used(out.nodes.size(), false);
+        used[out.root] = true;
+        for (size_t i = out.nodes.size(); i-- > 0;) {
+            if (!used[i]) continue;
+            if (out.nodes[i].lhs != ExprTree::NONE) used[out.nodes[i].lhs] = true;
+            if (out.nodes[i].rhs != ExprTree::NONE) used[out.nodes[i].rhs] = true;
+        }
+        std::vector<uint32_t> renamed(out.nodes.size(), ExprTree::NONE);
+        std::vector<Node> kept;
+        for (size_t i = 0; i < out.nodes.size(); ++i) {
+            if (!used[i]) continue;
+            Node node = out.nodes[i];
+            if (node.lhs != ExprTree::NONE) node.lhs = renamed[node.lhs];
+            if (node.rhs != ExprTree::NONE) node.rhs = renamed[node.rhs];
+            renamed[i] = static_cast<uint32_t>(kept.size());
+            kept.push_back(node);
+        }
+        out.root = renamed[out.root];
+        out.nodes.swap(kept);
     }
 
 public:
-    // Constructor
-    Calculator() {}
-
-    // Infix to Postfix conversion
-    std::string infixToPostfix(const std::string& expression) {
-        std::stack<char> operators;
-        std::string output;
-
-        for (size_t i = 0; i < expression.length(); ++i) {
-            if (isdigit(expression[i]) || expression[i] == '.') {
-                // Handle numbers (multiple digits or decimal numbers)
-                while (i < expression.length() && (isdigit(expression[i]) || expression[i] == '.')) {
-                    output += expression[i++];
-                }
-                output += ' ';  // Separate numbers in the postfix expression
-                --i;
-            } else if (expression[i] == '(') {
-                operators.push(expression[i]);
-            } else if (expression[i] == ')') {
-                while (!operators.empty() && operators.top() != '(') {
-                    output += operators.top();
-                    output += ' ';
-                    operators.pop();
-                }
-                if (!operators.empty()) operators.pop();  // Remove '('
-            } else if (isOperator(expression[i])) {
-                while (!operators.empty() && precedence(operators.top()) >= precedence(expression[i])) {
-                    output += operators.top();
-                    output += ' ';
-                    operators.pop();
-                }
-                operators.push(expression[i]);
+    static ExprTree optimize(const ExprTree& tree) {
+        ExprOptimizer optimizer;
+        optimizer.out.names = tree.names;
+        optimizer.out.nodes.reserve(tree.nodes.size());
+        optimizer.existing.reserve(tree.nodes.size());
+        std::vector<uint32_t> mapped(tree.nodes.size());
+        for (size_t i = 0; i < tree.nodes.size(); ++i) {
+            Node node = tree.nodes[i];
+            if (node.lhs != ExprTree::NONE) node.lhs = mapped[node.lhs];
+            if (node.rhs != ExprTree::NONE) node.rhs = mapped[node.rhs];
+            mapped[i] = optimizer.simplify(node);
+        }
+        optimizer.out.root = mapped[tree.root];
+        optimizer.compact();
+        return std::move(optimizer.out);
+    }
+};
+
+// Results evicted from a bounded ResultLog, kept on disk in memory-mapped segment files of
+// SEGMENT entries. Entry i lives at a fixed place, so writers never coordinate except when
+// creating a segment. Files are unlinked as soon as they are mapped, so nothing is left
+// behind; once a segment is full its pages are dropped from the process (they stay in the
+// page cache and are read back on demand).
+class SpillLog {
+private:
+    static constexpr size_t SEGMENT = size_t(1) << 17;      // Entries per file (1 MiB)
+    static constexpr size_t MAX_SEGMENTS = size_t(1) << 16;
+
+    std::string directory;
+    std::unique_ptr<std::atomic<double*>[]> segments;
+    std::unique_ptr<std::atomic<size_t>[]> written;  // Entries written per segment
+    std::mutex creating;
+
+    double* segmentFor(size_t segment) {
+        double* data = segments[segment].load(std::memory_order_acquire);
+        if (data) return data;
+        std::lock_guard<std::mutex> guard(creating);
+        data = segments[segment].load(std::memory_order_relaxed);
+        if (data) return data;
+#if defined(__unix__) || defined(__APPLE__)
+        std::string path = directory + "/calculator-" + std::to_string(reinterpret_cast<uintptr_t>(this)) +
+                           "-" + std::to_string(segment) + ".results";
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0) throw std::runtime_error("Cannot create spill file " + path);
+        void* mapped = MAP_FAILED;
+        if (::ftruncate(fd, SEGMENT * sizeof(double)) == 0) {
+            mapped = ::mmap(nullptr, SEGMENT * sizeof(double), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        ::unlink(path.c_str());
+        if (mapped == MAP_FAILED) throw std::runtime_error("Cannot map spill file " + path);
+        data = static_cast<double*>(mapped);
+#else
+        throw std::runtime_error("Spilling results to disk needs mmap");
+#endif
+        segments[segment].store(data, std::memory_order_release);
+        return data;
+    }
+
+public:
+    explicit SpillLog(const std::string& dir)
+        : directory(dir), segments(new std::atomic<double*>[MAX_SEGMENTS]()),
+          written(new std::atomic<size_t>[MAX_SEGMENTS]()) {}
+    SpillLog(const SpillLog&) = delete;
+    SpillLog& operator=(const SpillLog&) = delete;
+
+    ~SpillLog() {
+#if defined(__unix__) || defined(__APPLE__)
+        for (size_t i = 0; i < MAX_SEGMENTS; ++i) {
+            if (double* data = segments[i].load()) ::munmap(data, SEGMENT * sizeof(double));
+        }
+#endif
+    }
+
+    // Create the segment that will hold entry index (throws if it cannot be created)
+    void prepare(size_t index) {
+        if (index / SEGMENT >= MAX_SEGMENTS) throw std::length_error("Spill log is full");
+        segmentFor(index / SEGMENT);
+    }
+
+    // Store entry index, whose segment must have been prepared
+    void write(size_t index, double value) noexcept {
+        size_t segment = index / SEGMENT;
+        segments[segment].load(std::memory_order_acquire)[index % SEGMENT] = value;
+#if defined(__unix__) || defined(__APPLE__)
+        if (written[segment].fetch_add(1, std::memory_order_acq_rel) + 1 == SEGMENT) {
+            ::madvise(segments[segment].load(std::memory_order_relaxed), SEGMENT * sizeof(double), MADV_DONTNEED);
+        }
+#endif
+    }
+
+    // Entry at index, which must have been written (and published to this thread)
+    double read(size_t index) const {
+        return segments[index / SEGMENT].load(std::memory_order_acquire)[index % SEGMENT];
+    }
+};
+
+// Append-only log of results that many threads can append to and read at once without
+// locks. Indices are absolute and never change, so prev(n) compiled against one history
+// size keeps reading the same result however many are appended later.
+//
+// Unbounded, storage is a fixed directory of segments of doubling size (1024, 2048, ...), so
+// entries never move once written. An append claims an index with a compare-and-swap and
+// publishes the value with a per-entry ready flag; a reader of an index that was claimed but
+// not yet published waits for that one entry.
+//
+// Bounded, only the latest `capacity` results are kept in memory, in a ring whose slots are
+// guarded by a stamp (a seqlock): 2 * (index + 1) once result index is published, one less
+// while it is being written. Appending over a slot moves the evicted result to a SpillLog
+// if one was requested; otherwise reading it throws.
+class ResultLog {
+private:
+    static constexpr size_t FIRST_SEGMENT = 1024;
+    static constexpr size_t MAX_SEGMENTS = 48;
+
+    struct Segment {
+        std::unique_ptr<double[]> values;
+        std::unique_ptr<std::atomic<bool>[]> ready;
+
+        explicit Segment(size_t size) : values(new double[size]), ready(new std::atomic<bool>[size]()) {}
+    };
+
+    struct Slot {
+        std::atomic<size_t> stamp{0};
+        std::atomic<double> value{0};
+    };
+
+    std::atomic<Segment*> segments[MAX_SEGMENTS] = {};
+    std::atomic<size_t> claimed{0};
+    size_t capacity = 0;               // Zero when unbounded
+    std::unique_ptr<Slot[]> ring;
+    std::unique_ptr<SpillLog> spill;
+
+    // Segment number and offset within it of an index
+    static void locate(size_t index, size_t& segment, size_t& offset) {
+        size_t block = index / FIRST_SEGMENT + 1;
+        segment = 63 - static_cast<size_t>(__builtin_clzll(block));
+        offset = index - FIRST_SEGMENT * ((size_t(1) << segment) - 1);
+    }
+
+    Segment* segmentFor(size_t segment, bool create) {
+        Segment* current = segments[segment].load(std::memory_order_acquire);
+        if (current || !create) return current;
+        Segment* fresh = new Segment(FIRST_SEGMENT << segment);
+        if (segments[segment].compare_exchange_strong(current, fresh, std::memory_order_acq_rel)) return fresh;
+        delete fresh;  // Another thread installed it first
+        return current;
+    }
+
+    void appendToRing(size_t index, double value) {
+        Slot& slot = ring[index % capacity];
+        size_t stamp = 2 * (index + 1);
+        // Wait until the result being evicted is published (only when an append is a lap behind)
+        size_t evicted = index >= capacity ? stamp - 2 * capacity : 0;
+        while (slot.stamp.load(std::memory_order_acquire) != evicted) std::this_thread::yield();
+        if (spill && index >= capacity) spill->write(index - capacity, slot.value.load(std::memory_order_relaxed));
+        slot.stamp.store(stamp - 1, std::memory_order_release);  // Also publishes the spilled copy
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value.store(value, std::memory_order_relaxed);
+        slot.stamp.store(stamp, std::memory_order_release);
+    }
+
+    double readFromRing(size_t index) const {
+        const Slot& slot = ring[index % capacity];
+        size_t stamp = 2 * (index + 1);
+        for (;;) {
+            size_t before = slot.stamp.load(std::memory_order_acquire);
+            if (before > stamp) break;  // Overwritten by a later result
+            if (before == stamp) {
+                double value = slot.value.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.stamp.load(std::memory_order_relaxed) == stamp) return value;
+            } else {
+                std::this_thread::yield();  // Claimed but not yet published
+            }
+        }
+        if (!spill) throw std::out_of_range("Result has been evicted from the history");
+        return spill->read(index);
+    }
+
+    // Claim the next index. Storage it needs (its log segment, or the spill segment for the
+    // result it evicts) is created first, so nothing can fail once the index is taken and
+    // readers never wait for an entry that will not be published.
+    size_t claim() {
+        size_t index = claimed.load(std::memory_order_relaxed);
+        for (;;) {
+            if (capacity == 0) {
+                size_t segment, offset;
+                locate(index, segment, offset);
+                if (segment >= MAX_SEGMENTS) throw std::length_error("Result log is full");
+                segmentFor(segment, true);
+            } else if (spill && index >= capacity) {
+                spill->prepare(index - capacity);
+            }
+            if (claimed.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) return index;
+        }
+    }
+
+public:
+    // Keep every result in memory, or only the latest `capacity` (moving older ones to files
+    // in spillDirectory when one is given)
+    explicit ResultLog(size_t capacity = 0, const std::string& spillDirectory = "") : capacity(capacity) {
+        if (capacity > 0) {
+            ring.reset(new Slot[capacity]);
+            if (!spillDirectory.empty()) spill.reset(new SpillLog(spillDirectory));
+        }
+    }
+    ResultLog(const ResultLog&) = delete;
+    ResultLog& operator=(const ResultLog&) = delete;
+
+    ~ResultLog() {
+        for (std::atomic<Segment*>& segment : segments) delete segment.load();
+    }
+
+    // Append a result and return its index
+    size_t append(double value) {
+        size_t index = claim();
+        if (capacity > 0) {
+            appendToRing(index, value);
+            return index;
+        }
+        size_t segment, offset;
+        locate(index, segment, offset);
+        Segment* storage = segmentFor(segment, false);
+        storage->values[offset] = value;
+        storage->ready[offset].store(true, std::memory_order_release);
+        return index;
+    }
+
+    // Number of results appended (some may still be in the middle of being published)
+    size_t size() const {
+        return claimed.load(std::memory_order_acquire);
+    }
+
+    // Index of the oldest result that can still be read
+    size_t oldest() const {
+        size_t count = size();
+        return capacity == 0 || spill || count <= capacity ? 0 : count - capacity;
+    }
+
+    // Result at index, which must be below size(). Throws std::out_of_range if it was evicted.
+    double operator[](size_t index) const {
+        if (capacity > 0) return readFromRing(index);
+        size_t segment, offset;
+        locate(index, segment, offset);
+        const Segment* storage;
+        while (!(storage = segments[segment].load(std::memory_order_acquire))) std::this_thread::yield();
+        while (!storage->ready[offset].load(std::memory_order_acquire)) std::this_thread::yield();
+        return storage->values[offset];
+    }
+};
+
+// An expression parsed once into postfix bytecode. Numeric constants are parsed at compile
+// time, and eval() runs on a fixed-size value stack without allocating (deeper expressions
+// get a heap stack sized at compile time). Variables are numbered in order of first
+// appearance and bound when evaluating.
+class CompiledExpr {
+public:
+    static constexpr size_t MAX_STACK = 64;  // Value stack (and temporaries) kept on the C++ stack
+    static constexpr size_t BATCH = 64;      // Rows evaluated together by evalBatch
+
+private:
+    using Op = ExprOp;
+
+    struct Instr {
+        Op op;
+        size_t slot;   // Variable for Load, result index for Prev
+        double value;  // Constant for Push
+    };
+
+    std::vector<Instr> code;
+    const ResultLog* history = nullptr;  // Results read by Prev
+    std::vector<std::string> names;  // Variable names by slot
+    size_t maxDepth = 0;
+    size_t temps = 0;                // Saved common subexpressions
+
+    // Generate code from a tree or DAG. Operands are emitted depth first; a non-leaf node
+    // used more than once is saved to a temporary (Store) when first computed and reloaded
+    // (Fetch) afterwards. Leaves are cheaper to repeat than to save.
+    CompiledExpr(ExprTree&& tree, const ResultLog* results) : history(results), names(std::move(tree.names)) {
+        code.reserve(tree.nodes.size());
+        if (emitInOrder(tree)) return;
+        code.clear();
+        maxDepth = 0;
+
+        std::vector<uint32_t> uses(tree.nodes.size(), 0), temp(tree.nodes.size(), ExprTree::NONE);
+        for (const ExprTree::Node& node : tree.nodes) {
+            if (node.lhs != ExprTree::NONE) ++uses[node.lhs];
+            if (node.rhs != ExprTree::NONE) ++uses[node.rhs];
+        }
+        size_t depth = 0;
+        auto push = [&] {
+            maxDepth = std::max(maxDepth, ++depth);
+        };
+
+        std::vector<std::pair<uint32_t, bool>> work = {{tree.root, false}};  // Node, operands emitted
+        while (!work.empty()) {
+            auto [id, expanded] = work.back();
+            work.pop_back();
+            const ExprTree::Node& node = tree.nodes[id];
+            if (temp[id] != ExprTree::NONE) {
+                push();
+                code.push_back({Op::Fetch, temp[id], 0.0});
+                continue;
+            }
+            if (!expanded && node.lhs != ExprTree::NONE) {
+                work.push_back({id, true});
+                if (node.rhs != ExprTree::NONE) work.push_back({node.rhs, false});
+                work.push_back({node.lhs, false});
+                continue;
+            }
+            if (node.op <= Op::Prev) push();
+            else if (node.op >= Op::Add) --depth;
+            code.push_back({node.op, node.slot, node.value});
+            if (uses[id] > 1 && node.op > Op::Prev) {
+                temp[id] = static_cast<uint32_t>(temps++);
+                code.push_back({Op::Store, temp[id], 0.0});
             }
         }
+    }
 
-        // Pop all remaining operators
-        while (!operators.empty()) {
-            output += operators.top();
-            output += ' ';
-            operators.pop();
+    // Fast path for a tree already in postorder (as parsed): emit the nodes as they are.
+    // Returns false if the operands of some node are not the values on top of the stack.
+    bool emitInOrder(const ExprTree& tree) {
+        uint32_t ids[MAX_STACK];  // Node computing each stack entry
+        size_t depth = 0;
+        for (uint32_t id = 0; id < tree.nodes.size(); ++id) {
+            const ExprTree::Node& node = tree.nodes[id];
+            if (node.op >= Op::Add) {
+                if (depth < 2 || ids[depth - 2] != node.lhs || ids[depth - 1] != node.rhs) return false;
+                depth -= 2;
+            } else if (node.op >= Op::Neg) {
+                if (depth < 1 || ids[depth - 1] != node.lhs) return false;
+                --depth;
+            }
+            if (depth == MAX_STACK) return false;  // Deeper stacks take the general path
+            ids[depth++] = id;
+            maxDepth = std::max(maxDepth, depth);
+            code.push_back({node.op, node.slot, node.value});
         }
+        return depth == 1 && ids[0] == tree.root;
+    }
 
-        return output;
+    // Interpret the bytecode on the given value stack and temporaries
+    double run(const double* values, double* stack, double* saved) const {
+        size_t top = 0;
+        for (const Instr& instr : code) {
+            switch (instr.op) {
+                case Op::Push: stack[top++] = instr.value; break;
+                case Op::Load: stack[top++] = values[instr.slot]; break;
+                case Op::Prev: stack[top++] = (*history)[instr.slot]; break;
+                case Op::Fetch: stack[top++] = saved[instr.slot]; break;
+                case Op::Store: saved[instr.slot] = stack[top - 1]; break;
+                case Op::Neg: stack[top - 1] = -stack[top - 1]; break;
+                case Op::Sin: stack[top - 1] = sin(stack[top - 1]); break;
+                case Op::Sqrt: stack[top - 1] = sqrt(stack[top - 1]); break;
+                case Op::Add: --top; stack[top - 1] += stack[top]; break;
+                case Op::Sub: --top; stack[top - 1] -= stack[top]; break;
+                case Op::Mul: --top; stack[top - 1] *= stack[top]; break;
+                case Op::Div:
+                    --top;
+                    if (stack[top] == 0) throw std::runtime_error("Division by zero!");
+                    stack[top - 1] /= stack[top];
+                    break;
+                case Op::Pow: --top; stack[top - 1] = pow(stack[top - 1], stack[top]); break;
+                case Op::Min: --top; stack[top - 1] = std::min(stack[top - 1], stack[top]); break;
+                case Op::Max: --top; stack[top - 1] = std::max(stack[top - 1], stack[top]); break;
+            }
+        }
+        return stack[0];
     }
 
-    // Function to evaluate a postfix expression
-    double evaluatePostfix(const std::string& postfix) {
-        std::stack<double> values;
-        std::stringstream ss(postfix);
-        std::string token;
+    friend class Calculator;
 
-        while (ss >> token) {
-            if (isdigit(token[0]) || (token.length() > 1 && token[0] == '-')) {
-                // Token is a number
-                values.push(std::stod(token));
-            } else if (isOperator(token[0])) {
-                // Token is an operator, pop two values and apply the operator
-                if (values.size() < 2) throw std::runtime_error("Invalid expression");
-                double b = values.top(); values.pop();
-                double a = values.top(); values.pop();
-                values.push(applyOp(a, b, token[0]));
+    // Evaluate rows [begin, end) of the columns a block of BATCH rows at a time. Each
+    // instruction runs over the whole block, so the loops over rows vectorize.
+    void evalRange(const double* const* columns, double* out, size_t begin, size_t end) const {
+        std::vector<double> stack(maxDepth * BATCH), saved(temps * BATCH);
+        for (size_t row = begin; row < end; row += BATCH) {
+            size_t n = std::min(BATCH, end - row);
+            double* top = stack.data();  // One past the top block
+            for (const Instr& instr : code) {
+                if (instr.op >= Op::Add) top -= BATCH;  // Pop the second operand
+                const double* b = top;                   // Second operand of a binary op
+                double* a = instr.op >= Op::Store ? top - BATCH : top;  // Operand updated in place
+                switch (instr.op) {
+                    case Op::Push: std::fill(top, top + n, instr.value); top += BATCH; break;
+                    case Op::Load: std::memcpy(top, columns[instr.slot] + row, n * sizeof(double)); top += BATCH; break;
+                    case Op::Prev: std::fill(top, top + n, (*history)[instr.slot]); top += BATCH; break;
+                    case Op::Fetch: std::memcpy(top, &saved[instr.slot * BATCH], n * sizeof(double)); top += BATCH; break;
+                    case Op::Store: std::memcpy(&saved[instr.slot * BATCH], a, n * sizeof(double)); break;
+                    case Op::Neg: for (size_t r = 0; r < n; ++r) a[r] = -a[r]; break;
+                    case Op::Sin: for (size_t r = 0; r < n; ++r) a[r] = sin(a[r]); break;
+                    case Op::Sqrt: for (size_t r = 0; r < n; ++r) a[r] = sqrt(a[r]); break;
+                    case Op::Add: for (size_t r = 0; r < n; ++r) a[r] += b[r]; break;
+                    case Op::Sub: for (size_t r = 0; r < n; ++r) a[r] -= b[r]; break;
+                    case Op::Mul: for (size_t r = 0; r < n; ++r) a[r] *= b[r]; break;
+                    case Op::Div: {
+                        bool zero = false;
+                        for (size_t r = 0; r < n; ++r) zero |= b[r] == 0;
+                        if (zero) throw std::runtime_error("Division by zero!");
+                        for (size_t r = 0; r < n; ++r) a[r] /= b[r];
+                        break;
+                    }
+                    case Op::Pow: for (size_t r = 0; r < n; ++r) a[r] = pow(a[r], b[r]); break;
+                    case Op::Min: for (size_t r = 0; r < n; ++r) a[r] = std::min(a[r], b[r]); break;
+                    case Op::Max: for (size_t r = 0; r < n; ++r) a[r] = std::max(a[r], b[r]); break;
+                }
             }
+            std::memcpy(out + row, stack.data(), n * sizeof(double));
         }
+    }
 
-        if (values.size() != 1) throw std::runtime_error("Invalid expression");
-        return values.top();
+public:
+    // Evaluate an expression without variables
+    double eval() const {
+        if (!names.empty()) throw std::runtime_error("Unbound variable: " + names[0]);
+        return eval(nullptr);
     }
 
-    // Function to replace 'prev(index)' with the actual result value
-    std::string replacePrevResults(std::string expression) {
-        std::regex prevRegex("prev\\((\\d+)\\)");
-        std::smatch match;
+    // Evaluate with variable values given by slot (see variables())
+    double eval(const double* values) const {
+        if (maxDepth <= MAX_STACK && temps <= MAX_STACK) {
+            double stack[MAX_STACK], saved[MAX_STACK];
+            return run(values, stack, saved);
+        }
+        std::vector<double> stack(maxDepth), saved(temps);
+        return run(values, stack.data(), saved.data());
+    }
 
-        // Loop through all matches of prev(index) and replace them
-        while (std::regex_search(expression, match, prevRegex)) {
-            int index = std::stoi(match[1].str()) - 1;  // Convert to zero-based index
+    // Evaluate with variables bound by name
+    double eval(const std::map<std::string, double>& bindings) const {
+        double fixed[MAX_STACK];
+        std::vector<double> heap(names.size() > MAX_STACK ? names.size() : 0);
+        double* values = heap.empty() ? fixed : heap.data();
+        for (size_t i = 0; i < names.size(); ++i) {
+            auto it = bindings.find(names[i]);
+            if (it == bindings.end()) throw std::runtime_error("Unbound variable: " + names[i]);
+            values[i] = it->second;
+        }
+        return eval(values);
+    }
 
-            if (index >= 0 && index < previousResults.size()) {
-                // Replace 'prev(index)' with the actual result value
-                expression.replace(match.position(0), match.length(0), std::to_string(previousResults[index]));
-            } else {
-                throw std::out_of_range("Invalid 'prev(index)' value");
+    // Evaluate over `rows` rows of column data: columns[slot] holds the values of variable
+    // `slot` for every row, and the results go to out. Rows are split across threads.
+    void evalBatch(const std::vector<const double*>& columns, double* out, size_t rows, unsigned threads = 1) const {
+        if (columns.size() < names.size()) throw std::invalid_argument("Missing column for variable: " + names[columns.size()]);
+        threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>((rows + BATCH - 1) / BATCH)));
+        if (threads <= 1) {
+            evalRange(columns.data(), out, 0, rows);
+            return;
+        }
+
+        // Chunks are whole blocks so that threads never share a cache line of output
+        size_t blocks = (rows + BATCH - 1) / BATCH;
+        std::vector<std::thread> workers;
+        std::vector<std::exception_ptr> errors(threads);
+        for (unsigned t = 0; t < threads; ++t) {
+            size_t begin = std::min(rows, blocks * t / threads * BATCH);
+            size_t end = std::min(rows, blocks * (t + 1) / threads * BATCH);
+            workers.emplace_back([&, t, begin, end] {
+                try {
+                    evalRange(columns.data(), out, begin, end);
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+        for (const std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+    }
+
+    // Variable names, indexed by slot
+    const std::vector<std::string>& variables() const {
+        return names;
+    }
+
+    // Number of bytecode instructions
+    size_t size() const {
+        return code.size();
+    }
+};
+
+// LRU cache of results of Calculator::calculate, keyed on the expression text normalized so
+// that trivially different spellings share an entry: whitespace between tokens is dropped
+// and prev(index) is written in one canonical form. prev indices are absolute and stored
+// results never change, so an entry stays valid until a result it reads is evicted from a
+// bounded history; such entries are dropped when next looked up. Entries are charged their
+// key length plus a fixed overhead against a memory budget; a budget of zero disables it.
+class ResultCache {
+public:
+    struct Stats {
+        size_t hits = 0, misses = 0;
+        size_t evictions = 0;      // Dropped to stay within the budget
+        size_t invalidations = 0;  // Dropped because a result they read was evicted
+        size_t entries = 0, bytes = 0;
+    };
+
+    static constexpr size_t NO_PREV = SIZE_MAX;
+
+private:
+    struct Entry {
+        std::string key;
+        double result;
+        size_t firstPrev;  // Lowest result index read, or NO_PREV
+    };
+
+    static constexpr size_t ENTRY_OVERHEAD = sizeof(Entry) + 6 * sizeof(void*);  // List and hash nodes
+
+    mutable std::mutex lock;
+    std::list<Entry> recent;  // Most recently used first
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> entries;  // Keys point into `recent`
+    std::atomic<size_t> budget{0};
+    Stats counts;
+
+    // ASCII classes as the parser sees them in the C locale
+    static bool isSpace(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    static bool isWordChar(char c) {
+        return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c == '_' || c == '.';
+    }
+
+    void erase(std::list<Entry>::iterator entry) {
+        counts.bytes -= entry->key.size() + ENTRY_OVERHEAD;
+        entries.erase(entry->key);
+        recent.erase(entry);
+    }
+
+    void shrinkTo(size_t bytes) {
+        while (counts.bytes > bytes) {
+            erase(std::prev(recent.end()));
+            ++counts.evictions;
+        }
+    }
+
+public:
+    // Normalized form of an expression, and the lowest result index it reads. Returns false
+    // for text that should not be cached (a prev argument that is not a plain integer, or
+    // anything the parser would reject on its own).
+    static bool normalize(const std::string& expression, std::string& key, size_t& firstPrev) {
+        key.clear();
+        key.reserve(expression.size());
+        firstPrev = NO_PREV;
+        const char* p = expression.data();
+        const char* end = p + expression.size();
+        while (p < end) {
+            while (p < end && !isSpace(*p) && *p != '(') key += *p++;
+            if (p == end) break;
+
+            if (isSpace(*p)) {
+                while (p < end && isSpace(*p)) ++p;
+                if (p == end || key.empty()) continue;
+                // Keep one space where dropping it would join two tokens ("1 2", "1e -5")
+                char last = key.back();
+                if ((isWordChar(last) && isWordChar(*p)) || ((last == 'e' || last == 'E') && (*p == '+' || *p == '-'))) {
+                    key += ' ';
+                }
+                continue;
             }
+
+            // '(' after prev: canonical integer index
+            ++p;
+            size_t length = key.size();
+            key += '(';
+            if (length < 4 || key.compare(length - 4, 4, "prev") != 0 || (length > 4 && isWordChar(key[length - 5]))) continue;
+            while (p < end && isSpace(*p)) ++p;
+            double index = 0;
+            auto [next, error] = std::from_chars(p, end, index);
+            if (error != std::errc() || index < 1 || index != std::floor(index) || index > 1e18) return false;
+            p = next;
+            while (p < end && isSpace(*p)) ++p;
+            if (p == end || *p != ')') return false;
+            ++p;
+            size_t resultIndex = static_cast<size_t>(index) - 1;
+            firstPrev = std::min(firstPrev, resultIndex);
+            key += std::to_string(resultIndex + 1);
+            key += ')';
+        }
+        return !key.empty();
+    }
+
+    // Memory budget in bytes (zero disables the cache and drops every entry)
+    void setBudget(size_t bytes) {
+        std::lock_guard<std::mutex> guard(lock);
+        budget = bytes;
+        shrinkTo(bytes);
+    }
+
+    bool enabled() const {
+        return budget.load(std::memory_order_relaxed) > 0;
+    }
+
+    // Find the result for a normalized key. Entries reading a result below oldestReadable
+    // are invalidated.
+    bool lookup(const std::string& key, size_t oldestReadable, double& result) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = entries.find(key);
+        if (found == entries.end()) {
+            ++counts.misses;
+            return false;
+        }
+        std::list<Entry>::iterator entry = found->second;
+        if (entry->firstPrev != NO_PREV && entry->firstPrev < oldestReadable) {
+            erase(entry);
+            ++counts.invalidations;
+            ++counts.misses;
+            return false;
         }
+        recent.splice(recent.begin(), recent, entry);
+        ++counts.hits;
+        result = entry->result;
+        return true;
+    }
+
+    void insert(std::string&& key, double result, size_t firstPrev) {
+        size_t bytes = key.size() + ENTRY_OVERHEAD;
+        std::lock_guard<std::mutex> guard(lock);
+        size_t limit = budget.load(std::memory_order_relaxed);
+        if (bytes > limit) return;
+        auto found = entries.find(key);
+        if (found != entries.end()) erase(found->second);  // Another thread got there first
+        shrinkTo(limit - bytes);
+        recent.push_front(Entry{std::move(key), result, firstPrev});
+        entries.emplace(recent.front().key, recent.begin());
+        counts.bytes += bytes;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> guard(lock);
+        entries.clear();
+        recent.clear();
+        counts.bytes = 0;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> guard(lock);
+        Stats result = counts;
+        result.entries = recent.size();
+        return result;
+    }
+};
+
+// Every member function may be called from many threads at once: results go to a lock-free
+// ResultLog, and prev() and getPreviousResult read it without locking (the optional result
+// cache takes a mutex). The history can be bounded for long sessions; results keep their
+// index after older ones are evicted.
+class Calculator {
+private:
+    ResultLog previousResults;  // Stores previous results
+    ResultCache cache;          // Results of calculate(expression), when enabled
+
+public:
+    // Constructor. A historyCapacity above zero keeps only that many results in memory;
+    // older ones are moved to files in spillDirectory, or dropped if it is empty.
+    explicit Calculator(size_t historyCapacity = 0, const std::string& spillDirectory = "")
+        : previousResults(historyCapacity, spillDirectory) {}
 
-        return expression;
+    // Parse an expression once into bytecode that can be evaluated many times, by default
+    // simplified by ExprOptimizer. prev(index) reads the stored result when evaluated (so
+    // the Calculator must outlive the compiled expression); other names are variables.
+    CompiledExpr compile(const std::string& expression, bool optimize = true) {
+        ExprTree tree = ExprParser(expression, previousResults.size()).parse();
+        if (optimize) tree = ExprOptimizer::optimize(tree);
+        return CompiledExpr(std::move(tree), &previousResults);
     }
 
-    // Calculate an expression (infix form) and store the result
+    // Calculate an expression (infix form) and store the result. Evaluated once, so
+    // optimizing would cost more than it saves.
     double calculate(const std::string& expression) {
-        std::string updatedExpression = replacePrevResults(expression);  // Replace prev(index) placeholders
-        std::string postfix = infixToPostfix(updatedExpression);  // Convert to postfix
-        double result = evaluatePostfix(postfix);  // Evaluate the postfix expression
-        previousResults.push_back(result);  // Store the result for later use
+        std::string key;
+        size_t firstPrev;
+        if (cache.enabled() && ResultCache::normalize(expression, key, firstPrev)) {
+            double result;
+            if (!cache.lookup(key, previousResults.oldest(), result)) {
+                result = compile(expression, false).eval();
+                cache.insert(std::move(key), result, firstPrev);
+            }
+            previousResults.append(result);
+            return result;
+        }
+        double result = compile(expression, false).eval();
+        previousResults.append(result);  // Store the result for later use
+        return result;
+    }
+
+    // Calculate an expression with variables bound by name and store the result
+    double calculate(const std::string& expression, const std::map<std::string, double>& variables) {
+        double result = compile(expression, false).eval(variables);
+        previousResults.append(result);
         return result;
     }
 
-    // Access previous result by index
-    double getPreviousResult(size_t index) {
+    // Access previous result by index (throws std::out_of_range if it was evicted)
+    double getPreviousResult(size_t index) const {
         if (index >= previousResults.size()) throw std::out_of_range("No previous result at this index");
         return previousResults[index];
     }
 
+    // Memoize calculate(expression) in an LRU cache of about memoryBudget bytes (zero turns
+    // it off). Expressions with variables are never cached.
+    void enableCache(size_t memoryBudget) {
+        cache.setBudget(memoryBudget);
+    }
+
+    ResultCache::Stats cacheStats() const {
+        return cache.stats();
+    }
+
+    // Number of results calculated so far
+    size_t historySize() const {
+        return previousResults.size();
+    }
+
     // Print all previous results
     void printPreviousResults() const {
-        if (previousResults.empty()) {
+        size_t count = previousResults.size();
+        if (count == 0) {
             std::cout << "No previous results available." << std::endl;
             return;
         }
 
         std::cout << "Previous results:" << std::endl;
-        for (size_t i = 0; i < previousResults.size(); ++i) {
+        size_t first = previousResults.oldest();
+        if (first > 0) std::cout << "(" << first << " older results evicted)" << std::endl;
+        for (size_t i = first; i < count; ++i) {
             std::cout << i + 1 << ": " << previousResults[i] << std::endl;
         }
     }
 };
 
+// Time parsing, evaluation of compiled expressions, and batch evaluation
+void runBenchmarks() {
+    Calculator calc;
+    const int iterations = 200000;
+    volatile double sink = 0;
+
+    // Parser throughput over a small corpus
+    const std::vector<std::string> corpus = {
+        "1 + 2 * 3",
+        "(3.5 + 4.25) * 2 - 18 / (1.5 ^ 2) + 7 * (2 - 0.5)",
+        "x * x + 2 * x * y + y ^ 2",
+        "-b + sqrt(b ^ 2 - 4 * a * c) / (2 * a)",
+        "max(0, min(100, rate * principal / 12 + fee))",
+        "sin(2 * 3.14159 * t / 360) ^ 2 + -0.5 * 2 ^ -1",
+    };
+    for (bool optimize : {false, true}) {
+        size_t instructions = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) instructions += calc.compile(corpus[i % corpus.size()], optimize).size();
+        double parseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << (optimize ? "Parsing and optimizing: " : "Parsing: ") << iterations / parseSeconds / 1e6
+                  << " M expressions/s (" << instructions / iterations << " instructions on average)" << std::endl;
+    }
+
+    // Size of a formula corpus before and after optimization
+    const std::vector<std::string> formulas = {
+        "x * (2 * 3.14159) / 360",
+        "sin(x * (2 * 3.14159) / 360) ^ 2 + sin(x * (2 * 3.14159) / 360) * 2",
+        "(a + b) ^ 2 - (a + b) / 4 + sqrt((a + b) * (a + b))",
+        "max(x, x) * 1 + min(y / 2, y / 2) - 0",
+        "--rate * principal / 12 + fee * 1 ^ 3",
+        "(x - y) ^ 2 / 8 + (x - y) * (x - y) / 8",
+    };
+    size_t nodesBefore = 0, nodesAfter = 0, codeBefore = 0, codeAfter = 0;
+    for (const std::string& text : formulas) {
+        ExprTree tree = ExprParser(text, 0).parse();
+        nodesBefore += tree.nodes.size();
+        nodesAfter += ExprOptimizer::optimize(tree).nodes.size();
+        codeBefore += calc.compile(text, false).size();
+        codeAfter += calc.compile(text).size();
+    }
+    std::cout << "Optimizer on " << formulas.size() << " formulas: " << nodesBefore << " -> " << nodesAfter
+              << " nodes, " << codeBefore << " -> " << codeAfter << " instructions" << std::endl;
+    CompiledExpr plain = calc.compile(formulas[1], false), optimized = calc.compile(formulas[1]);
+    double angle[] = {30};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) sink = plain.eval(angle);
+    double plainSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) sink = optimized.eval(angle);
+    double optimizedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << formulas[1] << ": " << plainSeconds / iterations * 1e9 << " ns/eval unoptimized, "
+              << optimizedSeconds / iterations * 1e9 << " ns/eval optimized" << std::endl;
+
+    const std::string formula = "(3.5 + 4.25) * 2 - 18 / (1.5 ^ 2) + 7 * (2 - 0.5)";
+    CompiledExpr compiled = calc.compile(formula);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) sink = compiled.eval();
+    double compiledSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << formula << " = " << sink << std::endl;
+    std::cout << "Compiled bytecode (" << compiled.size() << " instructions): "
+              << compiledSeconds / iterations * 1e9 << " ns/eval" << std::endl;
+
+    // Per-expression latency with prev() references
+    calc.calculate("1.5");
+    calc.calculate("2.25");
+    calc.calculate("1/3");
+    const std::string withPrev = "prev(1) * 2 + prev(3) / 3 - prev(2)";
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) sink = calc.calculate(withPrev);
+    double prevSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout.precision(17);
+    std::cout << withPrev << " = " << sink;
+    std::cout.precision(6);
+    std::cout << ", " << prevSeconds / iterations * 1e9 << " ns/expr" << std::endl;
+
+    // Resubmitted expressions with and without the result cache
+    {
+        const std::vector<std::string> submitted = {
+            "(3.5 + 4.25) * 2 - 18 / (1.5 ^ 2) + 7 * (2 - 0.5)",
+            "(3.5+4.25)*2 - 18/(1.5^2) + 7*(2-0.5)",
+            "sqrt(2) * sin(1) + prev(1) * prev( 2 )",
+            "sqrt(2)*sin(1)+prev(1)*prev(2)",
+            "min(1, 2, 3, 4) + max(5, 6) ^ 2",
+        };
+        double seconds[2];
+        ResultCache::Stats stats;
+        for (int cached = 0; cached < 2; ++cached) {
+            Calculator session;
+            session.calculate("1.5");
+            session.calculate("2.5");
+            if (cached) session.enableCache(64 * 1024);
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) sink = session.calculate(submitted[i % submitted.size()]);
+            seconds[cached] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            stats = session.cacheStats();
+        }
+        std::cout << "Resubmitted expressions: " << seconds[0] / iterations * 1e9 << " ns uncached, "
+                  << seconds[1] / iterations * 1e9 << " ns cached (" << stats.hits << " hits, " << stats.misses
+                  << " misses, " << stats.entries << " entries, " << stats.bytes << " bytes)" << std::endl;
+    }
+
+    // Many threads sharing one Calculator and its result history
+    std::cout << "Concurrent calculate (shared history), M expressions/s:" << std::endl;
+    for (unsigned threads = 1; threads <= 64; threads *= 2) {
+        Calculator shared;
+        shared.calculate("1");
+        const int perThread = 400000 / threads;
+        std::vector<double> totals(threads);
+        auto work = [&shared, &totals, perThread](unsigned t) {
+            double total = 0;
+            for (int i = 0; i < perThread; ++i) {
+                total += shared.calculate("prev(1) * 2 + 0.5");
+                if (i % 16 == 0) total += shared.getPreviousResult((t * 7919 + i) % shared.historySize());
+            }
+            totals[t] = total;
+        };
+        std::vector<std::thread> workers;
+        start = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; ++t) workers.emplace_back(work, t);
+        for (std::thread& worker : workers) worker.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        sink = totals[0];
+        std::cout << "  " << threads << " thread(s): " << perThread * threads / seconds / 1e6
+                  << " (" << shared.historySize() << " results)" << std::endl;
+    }
+
+    // Appends alone: the lock-free log against a vector behind a mutex
+    for (unsigned threads : {1u, 8u, 64u}) {
+        const size_t perThread = 4000000 / threads;
+        ResultLog log;
+        std::vector<double> locked;
+        std::mutex lock;
+        double seconds[2];
+        for (int variant = 0; variant < 2; ++variant) {
+            std::vector<std::thread> workers;
+            start = std::chrono::steady_clock::now();
+            for (unsigned t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    for (size_t i = 0; i < perThread; ++i) {
+                        if (variant == 0) {
+                            log.append(t + i * 0.5);
+                        } else {
+                            std::lock_guard<std::mutex> guard(lock);
+                            locked.push_back(t + i * 0.5);
+                        }
+                    }
+                });
+            }
+            for (std::thread& worker : workers) worker.join();
+            seconds[variant] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::cout << "Appends, " << threads << " thread(s): lock-free " << perThread * threads / seconds[0] / 1e6
+                  << " M/s, mutex " << perThread * threads / seconds[1] / 1e6 << " M/s" << std::endl;
+    }
+
+    // Long sessions: appends to unbounded and bounded histories, then reading old results back
+    const size_t appends = 20000000;
+    const std::string spillDirectory = std::filesystem::temp_directory_path().string();
+    for (int variant = 0; variant < 3; ++variant) {
+        const char* names[] = {"unbounded", "ring of 4096", "ring of 4096 + spill"};
+        ResultLog log(variant == 0 ? 0 : 4096, variant == 2 ? spillDirectory : "");
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < appends; ++i) log.append(i * 0.25);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double total = 0;
+        for (size_t i = log.oldest(); i < appends; i += 997) total += log[i];
+        std::cout << "History, " << names[variant] << ": " << appends / seconds / 1e6 << " M appends/s, oldest readable "
+                  << log.oldest() << ", checksum " << total << std::endl;
+    }
+
+    // One formula over columns of data
+    CompiledExpr columnar = calc.compile("(x * 1.5 + y) * (x - y) / 2 + z");
+    const size_t rows = 10000000;
+    std::vector<double> x(rows), y(rows), z(rows), out(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        x[i] = i * 0.5;
+        y[i] = 3.0 - i * 0.25;
+        z[i] = i % 7;
+    }
+    std::vector<const double*> columns = {x.data(), y.data(), z.data()};
+    double bytes = rows * 4.0 * sizeof(double);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rows; ++i) {
+        double values[] = {x[i], y[i], z[i]};
+        out[i] = columnar.eval(values);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Row at a time: " << rows / seconds / 1e6 << " M rows/s" << std::endl;
+
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= hardware; threads *= 2) {
+        start = std::chrono::steady_clock::now();
+        columnar.evalBatch(columns, out.data(), rows, threads);
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Batch, " << threads << " thread(s): " << rows / seconds / 1e6 << " M rows/s, "
+                  << bytes / seconds / 1e9 << " GB/s (out[12345] = " << out[12345] << ")" << std::endl;
+    }
+}
+
 // Main function for testing the calculator
 int main() {
     Calculator calc;
@@ -166,10 +1336,14 @@ int main() {
 
     while (true) {
         try {
-            std::cout << "Enter an expression (or type 'prev' to see previous results, 'quit' to exit): ";
-            std::getline(std::cin, input);
+            std::cout << "Enter an expression (or type 'prev' to see previous results, 'bench' to time evaluation, 'quit' to exit): ";
+            if (!std::getline(std::cin, input)) break;
 
             if (input == "quit") break;
+            if (input == "bench") {
+                runBenchmarks();
+                continue;
+            }
             if (input == "prev") {
                 calc.printPreviousResults();
                 continue;
@@ -0,0 +1,379 @@
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <exception>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+
+// Sparse polynomial in up to 8 variables.
+// Each monomial's exponent vector is packed into one 64-bit key, variable 0 in the
+// highest field, so comparing keys as integers gives lexicographic order and
+// multiplying monomials is a single integer addition. The top bit of each field is
+// kept clear as a guard to detect exponent overflow.
+template <typename Coeff = double>
+class MultivariatePolynomial {
+public:
+    using Monomial = uint64_t;
+
+    struct Term {
+        Monomial mono;
+        Coeff coeff;
+    };
+
+private:
+    static constexpr Monomial EMPTY = ~Monomial(0); // Never a valid key: every guard bit is set
+
+    struct Slot {
+        Monomial mono = EMPTY;
+        Coeff coeff{};
+    };
+
+    int vars;              // Number of variables
+    int bits;              // Bits per variable field (including the guard bit)
+    Monomial guardMask;    // Top bit of every field
+    std::vector<Slot> slots; // Open-addressing hash table (linear probing, power-of-two size)
+    size_t count = 0;      // Occupied slots (terms may have a zero coefficient until normalized)
+
+    static bool isZero(const Coeff& c) {
+        if constexpr (std::is_floating_point_v<Coeff>) return std::abs(c) < 1e-9;
+        else return c == Coeff(0);
+    }
+
+    size_t hash(Monomial mono) const {
+        return static_cast<size_t>((mono * 0x9E3779B97F4A7C15ull) >> 32) & (slots.size() - 1);
+    }
+
+    // Find the slot holding mono, or the empty slot where it would go
+    size_t probe(Monomial mono) const {
+        size_t i = hash(mono);
+        while (slots[i].mono != EMPTY && slots[i].mono != mono) {
+            i = (i + 1) & (slots.size() - 1);
+        }
+        return i;
+    }
+
+    void rehash(size_t newSize) {
+        std::vector<Slot> old(newSize);
+        old.swap(slots);
+        count = 0;
+        for (const Slot& s : old) {
+            if (s.mono != EMPTY && !isZero(s.coeff)) {
+                size_t i = probe(s.mono);
+                slots[i] = s;
+                ++count;
+            }
+        }
+    }
+
+    // Add coeff to the term with the given packed monomial
+    void accumulate(Monomial mono, const Coeff& coeff) {
+        if ((count + 1) * 4 > slots.size() * 3) rehash(std::max<size_t>(16, slots.size() * 2));
+        size_t i = probe(mono);
+        if (slots[i].mono == EMPTY) {
+            slots[i].mono = mono;
+            slots[i].coeff = coeff;
+            ++count;
+        } else {
+            slots[i].coeff += coeff;
+        }
+    }
+
+    Monomial multiplyMonomials(Monomial a, Monomial b) const {
+        Monomial sum = a + b;
+        if ((sum & guardMask) != 0) throw std::overflow_error("Exponent overflow in monomial product");
+        return sum;
+    }
+
+    unsigned exponent(Monomial mono, int var) const {
+        int shift = (vars - 1 - var) * bits;
+        return static_cast<unsigned>((mono >> shift) & ((Monomial(1) << bits) - 1));
+    }
+
+    // Monagan–Pearce heap multiplication of f[begin, end) by g, both sorted descending.
+    // The heap holds at most one entry per term of f: popping (i, j) pushes (i, j + 1),
+    // and (i + 1, 0) is only pushed once (i, 0) has been consumed.
+    std::vector<Term> heapMultiply(const std::vector<Term>& f, size_t begin, size_t end,
+                                   const std::vector<Term>& g) const {
+        struct Entry {
+            Monomial mono;
+            size_t i, j;
+            bool operator<(const Entry& other) const { return mono < other.mono; }
+        };
+
+        std::vector<Term> result;
+        if (begin >= end || g.empty()) return result;
+
+        std::priority_queue<Entry> heap;
+        heap.push({multiplyMonomials(f[begin].mono, g[0].mono), begin, 0});
+        while (!heap.empty()) {
+            Monomial mono = heap.top().mono;
+            Coeff sum(0);
+            while (!heap.empty() && heap.top().mono == mono) {
+                Entry e = heap.top();
+                heap.pop();
+                sum += f[e.i].coeff * g[e.j].coeff;
+                if (e.j == 0 && e.i + 1 < end) {
+                    heap.push({multiplyMonomials(f[e.i + 1].mono, g[0].mono), e.i + 1, 0});
+                }
+                if (e.j + 1 < g.size()) {
+                    heap.push({multiplyMonomials(f[e.i].mono, g[e.j + 1].mono), e.i, e.j + 1});
+                }
+            }
+            if (!isZero(sum)) result.push_back({mono, sum});
+        }
+        return result;
+    }
+
+public:
+    // Constructors
+    explicit MultivariatePolynomial(int numVars = 1)
+        : vars(numVars), bits(numVars > 0 ? std::min(32, 64 / numVars) : 0), guardMask(0) {
+        if (numVars < 1 || numVars > 8) throw std::invalid_argument("Number of variables must be between 1 and 8");
+        for (int v = 0; v < vars; ++v) guardMask |= Monomial(1) << ((v + 1) * bits - 1);
+        slots.resize(16);
+    }
+
+    int variables() const { return vars; }
+
+    // Largest exponent a single variable may carry
+    unsigned maxExponent() const { return (1u << (bits - 1)) - 1; }
+
+    size_t termCount() const {
+        size_t n = 0;
+        for (const Slot& s : slots) {
+            if (s.mono != EMPTY && !isZero(s.coeff)) ++n;
+        }
+        return n;
+    }
+
+    // Pack an exponent vector into a monomial key
+    Monomial pack(const std::vector<unsigned>& exps) const {
+        if (static_cast<int>(exps.size()) != vars) throw std::invalid_argument("Exponent vector has wrong length");
+        Monomial mono = 0;
+        for (int v = 0; v < vars; ++v) {
+            if (exps[v] > maxExponent()) throw std::overflow_error("Exponent too large for packed monomial");
+            mono = (mono << bits) | exps[v];
+        }
+        return mono;
+    }
+
+    // Add coeff * x^exps to the polynomial
+    void addTerm(const std::vector<unsigned>& exps, const Coeff& coeff) {
+        accumulate(pack(exps), coeff);
+    }
+
+    // Coefficient of a specific monomial
+    Coeff coefficient(const std::vector<unsigned>& exps) const {
+        size_t i = probe(pack(exps));
+        return slots[i].mono == EMPTY ? Coeff(0) : slots[i].coeff;
+    }
+
+    // Non-zero terms sorted in descending (lexicographic) monomial order
+    std::vector<Term> sortedTerms() const {
+        std::vector<Term> terms;
+        terms.reserve(count);
+        for (const Slot& s : slots) {
+            if (s.mono != EMPTY && !isZero(s.coeff)) terms.push_back({s.mono, s.coeff});
+        }
+        std::sort(terms.begin(), terms.end(), [](const Term& a, const Term& b) { return a.mono > b.mono; });
+        return terms;
+    }
+
+    // Evaluate at a point (one value per variable)
+    Coeff evaluate(const std::vector<Coeff>& point) const {
+        if (static_cast<int>(point.size()) != vars) throw std::invalid_argument("Point has wrong dimension");
+        Coeff result(0);
+        for (const Slot& s : slots) {
+            if (s.mono == EMPTY) continue;
+            Coeff term = s.coeff;
+            for (int v = 0; v < vars; ++v) {
+                for (unsigned e = exponent(s.mono, v); e > 0; --e) term *= point[v];
+            }
+            result += term;
+        }
+        return result;
+    }
+
+    // Drop zero terms and shrink the table to fit
+    void normalize() {
+        size_t terms = termCount(), size = 16;
+        while (size * 3 < terms * 4) size *= 2;
+        rehash(size);
+    }
+
+    // Overloaded Operators for Polynomial Arithmetic
+
+    MultivariatePolynomial& operator+=(const MultivariatePolynomial& other) {
+        if (vars != other.vars) throw std::invalid_argument("Variable count mismatch");
+        if (this == &other) {
+            for (Slot& s : slots) s.coeff += s.coeff;
+            return *this;
+        }
+        for (const Slot& s : other.slots) {
+            if (s.mono != EMPTY) accumulate(s.mono, s.coeff);
+        }
+        return *this;
+    }
+
+    MultivariatePolynomial& operator-=(const MultivariatePolynomial& other) {
+        if (vars != other.vars) throw std::invalid_argument("Variable count mismatch");
+        if (this == &other) {
+            for (Slot& s : slots) s.coeff = Coeff(0);
+            return *this;
+        }
+        for (const Slot& s : other.slots) {
+            if (s.mono != EMPTY) accumulate(s.mono, Coeff(0) - s.coeff);
+        }
+        return *this;
+    }
+
+    MultivariatePolynomial operator+(const MultivariatePolynomial& other) const {
+        MultivariatePolynomial result(*this);
+        result += other;
+        return result;
+    }
+
+    MultivariatePolynomial operator-(const MultivariatePolynomial& other) const {
+        MultivariatePolynomial result(*this);
+        result -= other;
+        return result;
+    }
+
+    // Multiplication; large products split the terms of the left operand into chunks
+    // that are multiplied on separate threads and merged into the result table.
+    MultivariatePolynomial multiply(const MultivariatePolynomial& other, unsigned threads = 0) const {
+        if (vars != other.vars) throw std::invalid_argument("Variable count mismatch");
+        std::vector<Term> f = sortedTerms(), g = other.sortedTerms();
+        if (f.size() < g.size()) std::swap(f, g); // Chunk the longer operand
+
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        if (f.size() * g.size() < 100000) threads = 1;
+        threads = static_cast<unsigned>(std::min<size_t>(threads, f.size()));
+
+        std::vector<std::vector<Term>> partial(threads);
+        if (threads <= 1) {
+            partial.assign(1, heapMultiply(f, 0, f.size(), g));
+        } else {
+            std::vector<std::thread> workers;
+            std::vector<std::exception_ptr> errors(threads); // Exponent overflow, rethrown after joining
+            size_t chunk = (f.size() + threads - 1) / threads;
+            for (unsigned t = 0; t < threads; ++t) {
+                size_t begin = std::min(f.size(), t * chunk), end = std::min(f.size(), begin + chunk);
+                workers.emplace_back([&, t, begin, end] {
+                    try {
+                        partial[t] = heapMultiply(f, begin, end, g);
+                    } catch (...) {
+                        errors[t] = std::current_exception();
+                    }
+                });
+            }
+            for (std::thread& w : workers) w.join();
+            for (const std::exception_ptr& error : errors) {
+                if (error) std::rethrow_exception(error);
+            }
+        }
+
+        MultivariatePolynomial result(vars);
+        size_t total = 0;
+        for (const auto& p : partial) total += p.size();
+        size_t size = 16;
+        while (size * 3 < total * 4) size *= 2;
+        result.slots.assign(size, Slot{});
+        for (const auto& p : partial) {
+            for (const Term& t : p) result.accumulate(t.mono, t.coeff);
+        }
+        return result;
+    }
+
+    MultivariatePolynomial operator*(const MultivariatePolynomial& other) const {
+        return multiply(other);
+    }
+
+    MultivariatePolynomial& operator*=(const MultivariatePolynomial& other) {
+        *this = multiply(other);
+        return *this;
+    }
+
+    // Comparison operators
+    bool operator==(const MultivariatePolynomial& other) const {
+        if (vars != other.vars) return false;
+        std::vector<Term> a = sortedTerms(), b = other.sortedTerms();
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].mono != b[i].mono || !isZero(a[i].coeff - b[i].coeff)) return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const MultivariatePolynomial& other) const {
+        return !(*this == other);
+    }
+
+    // Output stream (printing), e.g. 3x^2y + z - 1
+    friend std::ostream& operator<<(std::ostream& os, const MultivariatePolynomial& poly) {
+        static const char names[] = "xyzwvuts";
+        std::vector<Term> terms = poly.sortedTerms();
+        if (terms.empty()) return os << 0;
+        bool first = true;
+        for (const Term& t : terms) {
+            Coeff c = t.coeff;
+            if constexpr (std::is_arithmetic_v<Coeff>) {
+                if (c < 0) {
+                    os << (first ? "-" : " - ");
+                    c = -c;
+                } else if (!first) {
+                    os << " + ";
+                }
+            } else if (!first) {
+                os << " + ";
+            }
+            if (t.mono == 0 || c != Coeff(1)) os << c;
+            for (int v = 0; v < poly.vars; ++v) {
+                unsigned e = poly.exponent(t.mono, v);
+                if (e == 0) continue;
+                os << names[v];
+                if (e > 1) os << "^" << e;
+            }
+            first = false;
+        }
+        return os;
+    }
+};
+
+// Example usage:
+int main() {
+    // (x + y + z + w + v + 1)^k in five variables
+    MultivariatePolynomial<double> base(5);
+    base.addTerm({0, 0, 0, 0, 0}, 1);
+    for (unsigned v = 0; v < 5; ++v) {
+        std::vector<unsigned> exps(5, 0);
+        exps[v] = 1;
+        base.addTerm(exps, 1);
+    }
+
+    MultivariatePolynomial<double> square = base * base;
+    std::cout << "Terms in (x + y + z + w + v + 1)^2: " << square.termCount() << "\n";
+    std::cout << "Coefficient of xy: " << square.coefficient({1, 1, 0, 0, 0}) << "\n";
+
+    MultivariatePolynomial<double> p = square;
+    for (int i = 0; i < 3; ++i) p *= square; // Degree 8
+    std::cout << "Terms in (x + y + z + w + v + 1)^8: " << p.termCount() << "\n";
+    std::cout << "Value at (1, 1, 1, 1, 1): " << p.evaluate({1, 1, 1, 1, 1}) << "\n"; // 6^8
+
+    // Addition and subtraction accumulate in place through the hash table
+    MultivariatePolynomial<double> q(2);
+    q.addTerm({2, 1}, 3);
+    q.addTerm({0, 1}, 1);
+    q.addTerm({0, 0}, -1);
+    MultivariatePolynomial<double> r(2);
+    r.addTerm({0, 1}, -1);
+    std::cout << "q: " << q << "\n";
+    std::cout << "q + r: " << q + r << "\n";
+    std::cout << "q * q: " << q * q << "\n";
+
+    return 0;
+}
@@ -1,24 +1,592 @@
 #include <iostream>
 #include <map>
 #include <cmath>
+#include <complex>
+#include <cstdint>
 #include <stdexcept>
 #include <sstream>
 #include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
+// Integer modulo a prime P, used for exact coefficient arithmetic.
+template <uint32_t P>
+class ModInt {
+private:
+    uint32_t value;
+
+public:
+    // Constructors
+    ModInt() : value(0) {}
+    ModInt(long long v) : value(static_cast<uint32_t>(((v % static_cast<long long>(P)) + P) % P)) {}
+
+    uint32_t get() const { return value; }
+    static constexpr uint32_t modulus() { return P; }
+
+    // Arithmetic
+    ModInt& operator+=(const ModInt& other) {
+        value += other.value;
+        if (value >= P) value -= P;
+        return *this;
+    }
+
+    ModInt& operator-=(const ModInt& other) {
+        value = (value >= other.value) ? value - other.value : value + P - other.value;
+        return *this;
+    }
+
+    ModInt& operator*=(const ModInt& other) {
+        value = static_cast<uint32_t>(static_cast<uint64_t>(value) * other.value % P);
+        return *this;
+    }
+
+    ModInt& operator/=(const ModInt& other) {
+        return *this *= other.inverse();
+    }
+
+    ModInt operator+(const ModInt& other) const { ModInt r(*this); return r += other; }
+    ModInt operator-(const ModInt& other) const { ModInt r(*this); return r -= other; }
+    ModInt operator*(const ModInt& other) const { ModInt r(*this); return r *= other; }
+    ModInt operator/(const ModInt& other) const { ModInt r(*this); return r /= other; }
+    ModInt operator-() const { return ModInt() - *this; }
+
+    // Exponentiation by squaring
+    ModInt pow(uint64_t n) const {
+        ModInt base(*this), result(1);
+        while (n) {
+            if (n & 1) result *= base;
+            base *= base;
+            n >>= 1;
+        }
+        return result;
+    }
+
+    // Multiplicative inverse (Fermat's little theorem, P must be prime)
+    ModInt inverse() const {
+        if (value == 0) throw std::runtime_error("Division by zero!");
+        return pow(P - 2);
+    }
+
+    bool operator==(const ModInt& other) const { return value == other.value; }
+    bool operator!=(const ModInt& other) const { return value != other.value; }
+
+    friend std::ostream& operator<<(std::ostream& os, const ModInt& m) {
+        return os << m.value;
+    }
+
+    friend std::istream& operator>>(std::istream& is, ModInt& m) {
+        long long v;
+        if (is >> v) m = ModInt(v);
+        return is;
+    }
+};
+
+// Text conversion through iostreams, the fallback for coefficient types without a faster path.
+// parse() returns the position after the value, or first if no value could be read.
+template <typename Coeff>
+struct StreamCoeffIO {
+    // End of the coefficient starting at first: the next whitespace, 'x' or +/- operator
+    // outside parentheses, so that "(1,-2)" and "1e-5" stay whole
+    static const char* tokenEnd(const char* first, const char* last) {
+        int depth = 0;
+        for (const char* p = first; p != last; ++p) {
+            char c = *p;
+            if (c == '(') {
+                ++depth;
+            } else if (c == ')') {
+                if (depth == 0) return p;
+                if (--depth == 0) return p + 1;
+            } else if (depth == 0) {
+                if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == 'x') return p;
+                if ((c == '+' || c == '-') && p != first && p[-1] != 'e' && p[-1] != 'E') return p;
+            }
+        }
+        return last;
+    }
+
+    // Only the coefficient's own characters go through the stream, so parsing a long
+    // polynomial stays linear
+    static const char* parse(const char* first, const char* last, Coeff& value) {
+        const char* end = tokenEnd(first, last);
+        std::istringstream ss(std::string(first, end));
+        if (!(ss >> value)) return first;
+        std::streamoff pos = ss.tellg();
+        return pos < 0 ? end : first + pos;
+    }
+
+    static void format(std::string& out, const Coeff& value) {
+        std::ostringstream ss;
+        ss << value;
+        out += ss.str();
+    }
+};
+
+// Describes how a coefficient type behaves inside a Polynomial.
+// The default assumes exact arithmetic (Fraction, integers): a term is zero only when
+// it compares equal to zero, and coefficients are printed as-is.
+template <typename Coeff>
+struct CoeffTraits : StreamCoeffIO<Coeff> {
+    static constexpr bool ordered = false; // Print with sign-aware " + " / " - " formatting
+    static bool isZero(const Coeff& c) { return c == Coeff(0); }
+};
+
+// Floating-point coefficients drop terms below a small threshold
+template <>
+struct CoeffTraits<double> {
+    static constexpr bool ordered = true;
+    static bool isZero(double c) { return std::abs(c) < 1e-9; }
+
+    static const char* parse(const char* first, const char* last, double& value) {
+        auto [ptr, ec] = std::from_chars(first, last, value);
+        return ec == std::errc() ? ptr : first;
+    }
+
+    // Shortest representation that reads back to the same value
+    static void format(std::string& out, double value) {
+        char buffer[32];
+        auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, ptr);
+    }
+};
+
+template <>
+struct CoeffTraits<std::complex<double>> : StreamCoeffIO<std::complex<double>> {
+    static constexpr bool ordered = false;
+    static bool isZero(const std::complex<double>& c) { return std::abs(c) < 1e-9; }
+};
+
+template <uint32_t P>
+struct CoeffTraits<ModInt<P>> {
+    static constexpr bool ordered = false;
+    static bool isZero(const ModInt<P>& c) { return c.get() == 0; }
+
+    static const char* parse(const char* first, const char* last, ModInt<P>& value) {
+        long long v;
+        auto [ptr, ec] = std::from_chars(first, last, v);
+        if (ec != std::errc()) return first;
+        value = ModInt<P>(v);
+        return ptr;
+    }
+
+    static void format(std::string& out, const ModInt<P>& value) {
+        char buffer[16];
+        auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value.get());
+        out.append(buffer, ptr);
+    }
+};
+
+// Dense multiplication: schoolbook for short inputs and Karatsuba above that.
+// Only ring operations are needed, so it is exact for exact coefficients.
+template <typename Coeff>
+struct KaratsubaMul {
+    static constexpr size_t karatsubaThreshold = 32;
+
+    // out[0 .. n+m-1) = a * b
+    static void schoolbook(const Coeff* a, size_t n, const Coeff* b, size_t m, Coeff* out) {
+        std::fill(out, out + n + m - 1, Coeff(0));
+        for (size_t i = 0; i < n; ++i) {
+            if (a[i] == Coeff(0)) continue;  // Exact test: small nonzero terms still count
+            for (size_t j = 0; j < m; ++j) {
+                out[i + j] += a[i] * b[j];
+            }
+        }
+    }
+
+    // out[0 .. 2n-1) = a * b, both of length n
+    static void karatsuba(const Coeff* a, const Coeff* b, size_t n, Coeff* out) {
+        if (n < karatsubaThreshold) {
+            schoolbook(a, n, b, n, out);
+            return;
+        }
+        size_t h = n / 2, k = n - h; // a = a0 + a1 x^h with |a0| = h, |a1| = k >= h
+
+        std::vector<Coeff> z0(2 * h - 1), z2(2 * k - 1), z1(2 * k - 1);
+        std::vector<Coeff> sa(a + h, a + n), sb(b + h, b + n);
+        karatsuba(a, b, h, z0.data());
+        karatsuba(a + h, b + h, k, z2.data());
+        for (size_t i = 0; i < h; ++i) {
+            sa[i] += a[i];
+            sb[i] += b[i];
+        }
+        karatsuba(sa.data(), sb.data(), k, z1.data());
+        for (size_t i = 0; i < z0.size(); ++i) z1[i] -= z0[i];
+        for (size_t i = 0; i < z2.size(); ++i) z1[i] -= z2[i];
+
+        std::fill(out, out + 2 * n - 1, Coeff(0));
+        for (size_t i = 0; i < z0.size(); ++i) out[i] += z0[i];
+        for (size_t i = 0; i < z1.size(); ++i) out[i + h] += z1[i];
+        for (size_t i = 0; i < z2.size(); ++i) out[i + 2 * h] += z2[i];
+    }
+
+    static void multiply(std::vector<Coeff>& a, std::vector<Coeff>& b, std::vector<Coeff>& out) {
+        size_t n = a.size(), m = b.size();
+        out.resize(n + m - 1);
+        if (std::min(n, m) < karatsubaThreshold) {
+            schoolbook(a.data(), n, b.data(), m, out.data());
+            return;
+        }
+        // Pad both operands to the same length; the extra high terms are zero
+        size_t len = std::max(n, m);
+        a.resize(len, Coeff(0));
+        b.resize(len, Coeff(0));
+        std::vector<Coeff> full(2 * len - 1);
+        karatsuba(a.data(), b.data(), len, full.data());
+        std::copy(full.begin(), full.begin() + (n + m - 1), out.begin());
+    }
+};
+
+// Dense multiplication backend, selected per coefficient type
+template <typename Coeff>
+struct MulBackend : KaratsubaMul<Coeff> {};
+
+// Modular coefficients use the number-theoretic transform when P has enough
+// factors of two (e.g. 998244353 = 119 * 2^23 + 1), otherwise Karatsuba.
+template <uint32_t P>
+struct MulBackend<ModInt<P>> {
+    using M = ModInt<P>;
+    static constexpr size_t nttThreshold = 64;
+
+    // Smallest generator of the multiplicative group mod P
+    static M primitiveRoot() {
+        static const M root = [] {
+            std::vector<uint32_t> factors;
+            uint32_t n = P - 1;
+            for (uint32_t d = 2; static_cast<uint64_t>(d) * d <= n; ++d) {
+                if (n % d == 0) {
+                    factors.push_back(d);
+                    while (n % d == 0) n /= d;
+                }
+            }
+            if (n > 1) factors.push_back(n);
+            for (uint32_t g = 2;; ++g) {
+                bool generator = true;
+                for (uint32_t f : factors) {
+                    if (M(g).pow((P - 1) / f) == M(1)) {
+                        generator = false;
+                        break;
+                    }
+                }
+                if (generator) return M(g);
+            }
+        }();
+        return root;
+    }
+
+    // In-place iterative NTT; size must be a power of two dividing P - 1
+    static void ntt(std::vector<M>& a, bool invert) {
+        size_t n = a.size();
+        for (size_t i = 1, j = 0; i < n; ++i) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) std::swap(a[i], a[j]);
+        }
+        for (size_t len = 2; len <= n; len <<= 1) {
+            M w = primitiveRoot().pow((P - 1) / len);
+            if (invert) w = w.inverse();
+            for (size_t i = 0; i < n; i += len) {
+                M wn(1);
+                for (size_t j = 0; j < len / 2; ++j) {
+                    M u = a[i + j], v = a[i + j + len / 2] * wn;
+                    a[i + j] = u + v;
+                    a[i + j + len / 2] = u - v;
+                    wn *= w;
+                }
+            }
+        }
+        if (invert) {
+            M nInv = M(static_cast<long long>(n)).inverse();
+            for (M& x : a) x *= nInv;
+        }
+    }
+
+    static void multiply(std::vector<M>& a, std::vector<M>& b, std::vector<M>& out) {
+        size_t n = a.size(), m = b.size();
+        size_t size = 1;
+        while (size < n + m - 1) size <<= 1;
+        if (std::min(n, m) < nttThreshold || (P - 1) % size != 0) {
+            KaratsubaMul<M>::multiply(a, b, out);
+            return;
+        }
+        a.resize(size);
+        b.resize(size);
+        ntt(a, false);
+        ntt(b, false);
+        for (size_t i = 0; i < size; ++i) a[i] *= b[i];
+        ntt(a, true);
+        out.assign(a.begin(), a.begin() + (n + m - 1));
+    }
+};
+
+// Immutable evaluator produced by Polynomial::compile().
+// Coefficients are stored densely in ascending order and zero-padded to a bucket
+// size; the evaluation routine for that bucket is chosen once at construction:
+//   up to 4 coefficients   - Horner, unrolled at compile time
+//   up to 32 coefficients  - Estrin, unrolled at compile time (more instruction-level parallelism)
+//   longer                 - four-way interleaved Horner over x^4
+template <typename Coeff>
+class CompiledPolynomial {
+public:
+    enum class Scheme { Horner, Estrin, SplitHorner };
+
+private:
+    using EvalFn = Coeff (*)(const Coeff*, size_t, const Coeff&);
+    using BatchFn = void (*)(const Coeff*, size_t, const Coeff*, Coeff*, size_t);
+
+    std::vector<Coeff> coeffs; // Ascending, padded with zeros to the bucket size
+    int deg;
+    Scheme scheme;
+    EvalFn evalFn;
+    BatchFn batchFn;
+
+    static constexpr size_t log2(size_t n) { return n <= 1 ? 0 : 1 + log2(n / 2); }
+
+    // c[I] + x * (c[I + 1] + x * (...)), expanded by template recursion
+    template <size_t I, size_t N>
+    static Coeff hornerStep(const Coeff* c, const Coeff& x) {
+        if constexpr (I + 1 == N) return c[I];
+        else return hornerStep<I + 1, N>(c, x) * x + c[I];
+    }
+
+    template <size_t N>
+    static Coeff hornerFixed(const Coeff* c, size_t, const Coeff& x) {
+        return hornerStep<0, N>(c, x);
+    }
+
+    // Low half + x^(N/2) * high half, with pw[k] = x^(2^k)
+    template <size_t N>
+    static Coeff estrinStep(const Coeff* c, const Coeff* pw) {
+        if constexpr (N == 1) return c[0];
+        else return estrinStep<N / 2>(c, pw) + pw[log2(N / 2)] * estrinStep<N / 2>(c + N / 2, pw);
+    }
+
+    template <size_t N>
+    static Coeff estrinFixed(const Coeff* c, size_t, const Coeff& x) {
+        Coeff pw[log2(N)];
+        pw[0] = x;
+        for (size_t k = 1; k < log2(N); ++k) pw[k] = pw[k - 1] * pw[k - 1];
+        return estrinStep<N>(c, pw);
+    }
+
+    // Four independent Horner chains in x^4 (n is a multiple of 4)
+    static Coeff splitHorner(const Coeff* c, size_t n, const Coeff& x) {
+        Coeff x2 = x * x, x4 = x2 * x2;
+        Coeff r0 = c[n - 4], r1 = c[n - 3], r2 = c[n - 2], r3 = c[n - 1];
+        for (size_t i = n - 4; i >= 4; i -= 4) {
+            r0 = r0 * x4 + c[i - 4];
+            r1 = r1 * x4 + c[i - 3];
+            r2 = r2 * x4 + c[i - 2];
+            r3 = r3 * x4 + c[i - 1];
+        }
+        return (r0 + x * r1) + x2 * (r2 + x * r3);
+    }
+
+    // Loop over many points with the routine known at compile time, so it is inlined
+    // and the loop can be vectorized across points
+    template <EvalFn F>
+    static void batch(const Coeff* c, size_t n, const Coeff* xs, Coeff* out, size_t count) {
+        for (size_t i = 0; i < count; ++i) out[i] = F(c, n, xs[i]);
+    }
+
+    template <size_t N, EvalFn F>
+    void select(Scheme s) {
+        coeffs.resize(N, Coeff(0));
+        scheme = s;
+        evalFn = F;
+        batchFn = &batch<F>;
+    }
+
+public:
+    // Build from dense ascending coefficients (coeffs[i] multiplies x^i)
+    explicit CompiledPolynomial(std::vector<Coeff> dense)
+        : coeffs(std::move(dense)), deg(static_cast<int>(coeffs.size()) - 1) {
+        size_t n = coeffs.size();
+        if (n <= 4) select<4, &hornerFixed<4>>(Scheme::Horner);
+        else if (n <= 8) select<8, &estrinFixed<8>>(Scheme::Estrin);
+        else if (n <= 16) select<16, &estrinFixed<16>>(Scheme::Estrin);
+        else if (n <= 32) select<32, &estrinFixed<32>>(Scheme::Estrin);
+        else {
+            coeffs.resize((n + 3) / 4 * 4, Coeff(0));
+            scheme = Scheme::SplitHorner;
+            evalFn = &splitHorner;
+            batchFn = &batch<&splitHorner>;
+        }
+    }
+
+    int degree() const { return deg; }
+    Scheme evaluationScheme() const { return scheme; }
+
+    // Evaluate at a single point
+    Coeff operator()(const Coeff& x) const {
+        return evalFn(coeffs.data(), coeffs.size(), x);
+    }
+
+    // Evaluate at count points: out[i] = p(xs[i])
+    void evaluate(const Coeff* xs, Coeff* out, size_t count) const {
+        batchFn(coeffs.data(), coeffs.size(), xs, out, count);
+    }
+};
+
+// Polynomial of fixed degree N known at compile time; usable in constant expressions.
+template <size_t N, typename Coeff = double>
+class StaticPolynomial {
+private:
+    std::array<Coeff, N + 1> coeffs; // Ascending: coeffs[i] multiplies x^i
+
+    template <size_t, typename> friend class StaticPolynomial;
+
+public:
+    // Construct from N + 1 coefficients, lowest degree first (no arguments gives zero)
+    template <typename... Ts>
+    constexpr StaticPolynomial(Ts... cs) : coeffs{static_cast<Coeff>(cs)...} {
+        static_assert(sizeof...(Ts) == N + 1 || sizeof...(Ts) == 0, "StaticPolynomial<N> takes N + 1 coefficients");
+    }
+
+    static constexpr size_t degree() { return N; }
+
+    constexpr Coeff operator[](size_t exp) const { return coeffs[exp]; }
+
+    // Horner's scheme; the loop bound is a constant, so it unrolls completely
+    constexpr Coeff operator()(const Coeff& x) const {
+        Coeff result = coeffs[N];
+        for (size_t i = N; i-- > 0;) result = result * x + coeffs[i];
+        return result;
+    }
+
+    // Derivative (a constant's derivative is the zero constant)
+    constexpr StaticPolynomial<(N > 0 ? N - 1 : 0), Coeff> derivative() const {
+        StaticPolynomial<(N > 0 ? N - 1 : 0), Coeff> result{};
+        if constexpr (N > 0) {
+            for (size_t i = 1; i <= N; ++i) result.coeffs[i - 1] = coeffs[i] * Coeff(i);
+        }
+        return result;
+    }
+};
+
+template <typename Coeff = double>
 class Polynomial {
 private:
+    using Traits = CoeffTraits<Coeff>;
+    using TermMap = std::map<int, Coeff>;
+
     // Using a map to store the coefficients, where the key is the exponent and the value is the coefficient.
-    std::map<int, double> terms; // Example: 3x^2 + 4x + 5 will be stored as {{2, 3}, {1, 4}, {0, 5}}
+    TermMap terms; // Example: 3x^2 + 4x + 5 will be stored as {{2, 3}, {1, 4}, {0, 5}}
+    bool dirty = false; // True when zero terms may be present (normalization deferred)
+
+    using Node = typename TermMap::node_type;
+
+    // Scratch arena reused by multiplication: dense operand/result buffers plus a pool
+    // of detached map nodes, so repeated products do not go back to the allocator.
+    // Both are capped so that one large product does not pin memory for the thread's life.
+    struct Scratch {
+        static constexpr size_t MAX_NODES = 4096;
+        static constexpr size_t MAX_DENSE = size_t(1) << 16;
+
+        std::vector<Coeff> lhs, rhs, dense;
+        std::vector<Node> nodes;
+
+        // Give back dense buffers that grew past the cap
+        void trim() {
+            if (dense.capacity() > MAX_DENSE) std::vector<Coeff>().swap(dense);
+            if (lhs.capacity() > MAX_DENSE) std::vector<Coeff>().swap(lhs);
+            if (rhs.capacity() > MAX_DENSE) std::vector<Coeff>().swap(rhs);
+        }
+    };
+
+    static Scratch& scratch() {
+        thread_local Scratch arena;
+        return arena;
+    }
+
+    // Keep a detached node for reuse, or free it if the pool is full
+    static void recycle(Node&& node) {
+        auto& pool = scratch().nodes;
+        if (pool.size() < Scratch::MAX_NODES) pool.push_back(std::move(node));
+    }
+
+    // Apply a deferred normalization, if any
+    void normalizeIfDirty() {
+        if (!dirty) return;
+        for (auto it = terms.begin(); it != terms.end();) {
+            if (Traits::isZero(it->second)) {
+                recycle(terms.extract(it++));
+            } else {
+                ++it;
+            }
+        }
+        dirty = false;
+    }
+
+    // Const observers never normalize (so a const Polynomial can be read from many
+    // threads); they skip the zero terms a dirty polynomial may hold instead.
+    bool live(const Coeff& coeff) const {
+        return !dirty || !Traits::isZero(coeff);
+    }
+
+    // Insert (exp, coeff) reusing a pooled node when one is available
+    void insertTerm(typename TermMap::const_iterator hint, int exp, const Coeff& coeff) {
+        auto& pool = scratch().nodes;
+        if (pool.empty()) {
+            terms.emplace_hint(hint, exp, coeff);
+            return;
+        }
+        Node node = std::move(pool.back());
+        pool.pop_back();
+        node.key() = exp;
+        node.mapped() = coeff;
+        terms.insert(hint, std::move(node));
+    }
+
+    // Move every term into the node pool
+    void recycleTerms() {
+        for (auto it = terms.begin(); it != terms.end();) recycle(terms.extract(it++));
+    }
+
+    // Merge other's terms into this one; both maps are sorted, so a single forward
+    // pass with insertion hints suffices.
+    void accumulate(const Polynomial& other, bool subtract) {
+        auto it = terms.begin();
+        for (const auto& [exp, coeff] : other.terms) {
+            while (it != terms.end() && it->first < exp) ++it;
+            if (it != terms.end() && it->first == exp) {
+                if (subtract) it->second -= coeff;
+                else it->second += coeff;
+            } else {
+                insertTerm(it, exp, subtract ? Coeff(0) - coeff : coeff);
+            }
+        }
+        dirty = true;
+    }
+
+    // x^n by repeated squaring (negative n requires division in the coefficient ring)
+    static Coeff power(Coeff base, int n) {
+        bool negative = n < 0;
+        unsigned e = negative ? 0u - static_cast<unsigned>(n) : static_cast<unsigned>(n);
+        Coeff result(1);
+        while (e) {
+            if (e & 1) result *= base;
+            base *= base;
+            e >>= 1;
+        }
+        return negative ? Coeff(1) / result : result;
+    }
 
 public:
     // Constructors
     Polynomial() = default;
 
     // Construct polynomial from a vector of coefficients (e.g., {5, 4, 3} -> 3x^2 + 4x + 5)
-    Polynomial(const std::initializer_list<double>& coeffs) {
+    Polynomial(const std::initializer_list<Coeff>& coeffs) {
         int exp = 0;
-        for (double coeff : coeffs) {
-            if (coeff != 0) {
+        for (const Coeff& coeff : coeffs) {
+            if (coeff != Coeff(0)) {
                 terms[exp] = coeff;
             }
             ++exp;
@@ -26,15 +594,16 @@ public:
     }
 
     // Copy constructor
-    Polynomial(const Polynomial& other) : terms(other.terms) {}
+    Polynomial(const Polynomial& other) : terms(other.terms), dirty(other.dirty) {}
 
     // Move constructor
-    Polynomial(Polynomial&& other) noexcept : terms(std::move(other.terms)) {}
+    Polynomial(Polynomial&& other) noexcept : terms(std::move(other.terms)), dirty(other.dirty) {}
 
     // Copy assignment
     Polynomial& operator=(const Polynomial& other) {
         if (this != &other) {
             terms = other.terms;
+            dirty = other.dirty;
         }
         return *this;
     }
@@ -43,34 +612,53 @@ public:
     Polynomial& operator=(Polynomial&& other) noexcept {
         if (this != &other) {
             terms = std::move(other.terms);
+            dirty = other.dirty;
         }
         return *this;
     }
 
     // Get degree of the polynomial (highest exponent)
     int degree() const {
-        if (terms.empty()) return -1; // Degree of the zero polynomial is conventionally -1
-        return terms.rbegin()->first; // Highest exponent
+        for (auto it = terms.rbegin(); it != terms.rend(); ++it) {
+            if (live(it->second)) return it->first; // Highest exponent
+        }
+        return -1; // Degree of the zero polynomial is conventionally -1
     }
 
     // Access coefficient of a specific term (const)
-    double operator[](int exp) const {
+    Coeff operator[](int exp) const {
         auto it = terms.find(exp);
-        return (it != terms.end()) ? it->second : 0.0;
+        return (it != terms.end()) ? it->second : Coeff(0);
     }
 
     // Access coefficient of a specific term (non-const)
-    double& operator[](int exp) {
+    Coeff& operator[](int exp) {
+        dirty = true; // The caller may write a zero
         return terms[exp];
     }
 
-    // Evaluate the polynomial at a given value of x
-    double evaluate(double x) const {
-        double result = 0.0;
+    // Evaluate the polynomial at a given value of x (Horner's scheme over the sparse terms)
+    Coeff evaluate(const Coeff& x) const {
+        if (terms.empty()) return Coeff(0);
+        Coeff result(0);
+        int prevExp = terms.rbegin()->first;
+        for (auto it = terms.rbegin(); it != terms.rend(); ++it) {
+            result = result * power(x, prevExp - it->first) + it->second;
+            prevExp = it->first;
+        }
+        return result * power(x, prevExp);
+    }
+
+    // Build an immutable evaluator for repeated evaluation (exponents must be non-negative)
+    CompiledPolynomial<Coeff> compile() const {
+        int top = degree();
+        std::vector<Coeff> dense(top < 0 ? 1 : top + 1, Coeff(0));
         for (const auto& [exp, coeff] : terms) {
-            result += coeff * std::pow(x, exp);
+            if (!live(coeff)) continue;
+            if (exp < 0) throw std::domain_error("Cannot compile a polynomial with negative exponents");
+            dense[exp] = coeff;
         }
-        return result;
+        return CompiledPolynomial<Coeff>(std::move(dense));
     }
 
     // Derivative of the polynomial
@@ -78,9 +666,10 @@ public:
         Polynomial result;
         for (const auto& [exp, coeff] : terms) {
             if (exp > 0) {
-                result.terms[exp - 1] = coeff * exp;
+                result.terms[exp - 1] = coeff * Coeff(exp);
             }
         }
+        result.dirty = true; // exp may be a multiple of the characteristic
         return result;
     }
 
@@ -88,69 +677,140 @@ public:
     Polynomial integral() const {
         Polynomial result;
         for (const auto& [exp, coeff] : terms) {
-            result.terms[exp + 1] = coeff / (exp + 1);
+            result.terms[exp + 1] = coeff / Coeff(exp + 1);
         }
+        result.dirty = dirty; // Zero terms of a dirty polynomial carry over
         return result;
     }
 
     // Normalize the polynomial (remove zero terms)
     void normalize() {
-        for (auto it = terms.begin(); it != terms.end();) {
-            if (std::abs(it->second) < 1e-9) {
-                it = terms.erase(it);
-            } else {
-                ++it;
+        dirty = true;
+        normalizeIfDirty();
+    }
+
+    // Overloaded Operators for Polynomial Arithmetic
+
+    // Compound addition (in place; normalization is deferred)
+    Polynomial& operator+=(const Polynomial& other) {
+        accumulate(other, false);
+        return *this;
+    }
+
+    // Compound subtraction (in place; normalization is deferred)
+    Polynomial& operator-=(const Polynomial& other) {
+        if (this == &other) {
+            for (auto& [exp, coeff] : terms) coeff = Coeff(0);
+            dirty = true;
+            return *this;
+        }
+        accumulate(other, true);
+        return *this;
+    }
+
+    // Compound multiplication by another polynomial
+    Polynomial& operator*=(const Polynomial& other) {
+        if (terms.empty() || other.terms.empty()) {
+            recycleTerms();
+            dirty = false;
+            return *this;
+        }
+
+        int lowA = terms.begin()->first, lowB = other.terms.begin()->first;
+        size_t spanA = static_cast<size_t>(static_cast<long long>(terms.rbegin()->first) - lowA) + 1;
+        size_t spanB = static_cast<size_t>(static_cast<long long>(other.terms.rbegin()->first) - lowB) + 1;
+
+        if (spanA > 4 * terms.size() + 64 || spanB > 4 * other.terms.size() + 64) {
+            // Very sparse operands: dense buffers would be mostly empty
+            TermMap product;
+            for (const auto& [exp1, coeff1] : terms) {
+                for (const auto& [exp2, coeff2] : other.terms) {
+                    product[exp1 + exp2] += coeff1 * coeff2;
+                }
             }
+            terms.swap(product);
+            dirty = true;
+            return *this;
         }
+
+        // Lay both operands out densely and hand them to the coefficient's backend
+        Scratch& arena = scratch();
+        arena.lhs.assign(spanA, Coeff(0));
+        arena.rhs.assign(spanB, Coeff(0));
+        for (const auto& [exp, coeff] : terms) arena.lhs[exp - lowA] = coeff;
+        for (const auto& [exp, coeff] : other.terms) arena.rhs[exp - lowB] = coeff;
+        MulBackend<Coeff>::multiply(arena.lhs, arena.rhs, arena.dense);
+
+        // Recycle our own nodes, then rebuild from the product in ascending order
+        recycleTerms();
+        int low = lowA + lowB;
+        for (size_t i = 0; i < spanA + spanB - 1; ++i) {
+            if (!Traits::isZero(arena.dense[i])) {
+                insertTerm(terms.end(), low + static_cast<int>(i), arena.dense[i]);
+            }
+        }
+        arena.trim();
+        dirty = false;
+        return *this;
     }
 
-    // Overloaded Operators for Polynomial Arithmetic
+    // Compound scalar multiplication
+    Polynomial& operator*=(const Coeff& scalar) {
+        for (auto& [exp, coeff] : terms) coeff *= scalar;
+        dirty = true;
+        return *this;
+    }
 
     // Addition
-    Polynomial operator+(const Polynomial& other) const {
+    Polynomial operator+(const Polynomial& other) const & {
         Polynomial result(*this);
-        for (const auto& [exp, coeff] : other.terms) {
-            result[exp] += coeff;
-        }
-        result.normalize();
+        result += other;
         return result;
     }
 
+    Polynomial operator+(const Polynomial& other) && {
+        *this += other;
+        return std::move(*this);
+    }
+
     // Subtraction
-    Polynomial operator-(const Polynomial& other) const {
+    Polynomial operator-(const Polynomial& other) const & {
         Polynomial result(*this);
-        for (const auto& [exp, coeff] : other.terms) {
-            result[exp] -= coeff;
-        }
-        result.normalize();
+        result -= other;
         return result;
     }
 
+    Polynomial operator-(const Polynomial& other) && {
+        *this -= other;
+        return std::move(*this);
+    }
+
     // Multiplication by another polynomial
     Polynomial operator*(const Polynomial& other) const {
-        Polynomial result;
-        for (const auto& [exp1, coeff1] : terms) {
-            for (const auto& [exp2, coeff2] : other.terms) {
-                result[exp1 + exp2] += coeff1 * coeff2;
-            }
-        }
-        result.normalize();
+        Polynomial result(*this);
+        result *= other;
         return result;
     }
 
     // Scalar multiplication
-    Polynomial operator*(double scalar) const {
-        Polynomial result;
-        for (const auto& [exp, coeff] : terms) {
-            result[exp] = coeff * scalar;
-        }
-        result.normalize();
+    Polynomial operator*(const Coeff& scalar) const {
+        Polynomial result(*this);
+        result *= scalar;
         return result;
     }
 
     // Comparison operators
     bool operator==(const Polynomial& other) const {
-        return terms == other.terms;
+        if (!dirty && !other.dirty) return terms == other.terms;
+        auto a = terms.begin(), b = other.terms.begin();
+        for (;;) {
+            while (a != terms.end() && !live(a->second)) ++a;
+            while (b != other.terms.end() && !other.live(b->second)) ++b;
+            if (a == terms.end() || b == other.terms.end()) return a == terms.end() && b == other.terms.end();
+            if (a->first != b->first || !(a->second == b->second)) return false;
+            ++a;
+            ++b;
+        }
     }
 
     bool operator!=(const Polynomial& other) const {
@@ -161,9 +821,16 @@ public:
     friend std::ostream& operator<<(std::ostream& os, const Polynomial& poly) {
         bool first = true;
         for (auto it = poly.terms.rbegin(); it != poly.terms.rend(); ++it) {
-            if (!first && it->second > 0) os << " + ";
-            if (it->second < 0) os << " - ";
-            if (std::abs(it->second) != 1 || it->first == 0) os << std::abs(it->second);
+            if (!poly.live(it->second)) continue;
+            if constexpr (Traits::ordered) {
+                if (!first && it->second > 0) os << " + ";
+                if (it->second < 0) os << " - ";
+                if (std::abs(it->second) != 1 || it->first == 0) os << std::abs(it->second);
+            } else {
+                // Unordered rings (complex, modular): no sign folding
+                if (!first) os << " + ";
+                if (it->second != Coeff(1) || it->first == 0) os << it->second;
+            }
             if (it->first != 0) os << "x";
             if (it->first > 1) os << "^" << it->first;
             first = false;
@@ -171,33 +838,173 @@ public:
         return os;
     }
 
-    // Input stream (reading a polynomial)
+    // Input stream (reading a polynomial from one line; see parse() for the syntax)
     friend std::istream& operator>>(std::istream& is, Polynomial& poly) {
         std::string input;
-        std::getline(is, input);
-        std::istringstream ss(input);
-
-        double coeff;
-        int exp;
-        char x, caret;
-        while (ss >> coeff) {
-            if (ss >> x >> caret >> exp) {
-                poly[exp] = coeff;
-            } else {
-                poly[0] = coeff;
-            }
+        if (!std::getline(is, input)) return is;
+        try {
+            poly = parse(input);
+        } catch (const std::invalid_argument&) {
+            is.setstate(std::ios::failbit);
         }
         return is;
     }
+
+    // Parse text such as "-4x^2 + 3", "2.5x^3 - x + 1" or "3x^2 4x 5" (terms without an
+    // operator are added). Repeated exponents are summed. Works directly on the
+    // caller's buffer without intermediate strings or streams.
+    static Polynomial parse(std::string_view text) {
+        Polynomial result;
+        const char* p = text.data();
+        const char* end = p + text.size();
+        auto skipSpace = [&] { while (p != end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p; };
+        auto fail = [&](const char* what) {
+            throw std::invalid_argument(std::string("Polynomial parse error at offset ") +
+                                        std::to_string(p - text.data()) + ": " + what);
+        };
+
+        skipSpace();
+        while (p != end) {
+            bool negative = false;
+            while (p != end && (*p == '+' || *p == '-')) {
+                if (*p == '-') negative = !negative;
+                ++p;
+                skipSpace();
+            }
+
+            Coeff coeff(1);
+            bool hasCoeff = false;
+            if (p != end && *p != 'x') {
+                const char* next = Traits::parse(p, end, coeff);
+                if (next == p) fail("expected a coefficient");
+                p = next;
+                hasCoeff = true;
+                skipSpace();
+            }
+
+            int exp = 0;
+            if (p != end && *p == 'x') {
+                ++p;
+                exp = 1;
+                skipSpace();
+                if (p != end && *p == '^') {
+                    ++p;
+                    skipSpace();
+                    auto [next, ec] = std::from_chars(p, end, exp);
+                    if (ec != std::errc()) fail("expected an exponent");
+                    p = next;
+                    skipSpace();
+                }
+            } else if (!hasCoeff) {
+                fail("expected a term");
+            }
+
+            if (negative) coeff = Coeff(0) - coeff;
+
+            // Text is usually written highest power first, so new terms go at the front
+            auto& terms = result.terms;
+            if (terms.empty() || exp < terms.begin()->first) terms.emplace_hint(terms.begin(), exp, coeff);
+            else if (exp > terms.rbegin()->first) terms.emplace_hint(terms.end(), exp, coeff);
+            else terms[exp] += coeff;
+        }
+        result.dirty = true;
+        return result;
+    }
+
+    // Append the text form (readable by parse()) to out; double coefficients are written
+    // in their shortest round-trip form
+    void format(std::string& out) const {
+        if (degree() < 0) {
+            out += '0';
+            return;
+        }
+        char buffer[16];
+        bool first = true;
+        for (auto it = terms.rbegin(); it != terms.rend(); ++it) {
+            if (!live(it->second)) continue;
+            Coeff coeff = it->second;
+            if constexpr (Traits::ordered) {
+                if (coeff < 0) {
+                    out += first ? "-" : " - ";
+                    coeff = -coeff;
+                } else if (!first) {
+                    out += " + ";
+                }
+            } else if (!first) {
+                out += " + ";
+            }
+            if (it->first == 0 || coeff != Coeff(1)) Traits::format(out, coeff);
+            if (it->first != 0) out += 'x';
+            if (it->first != 0 && it->first != 1) {
+                out += '^';
+                auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), it->first);
+                out.append(buffer, ptr);
+            }
+            first = false;
+        }
+    }
+
+    std::string toString() const {
+        std::string out;
+        out.reserve(terms.size() * 16);
+        format(out);
+        return out;
+    }
+
+    // Compact binary format: the tag "PLY1", a uint64 term count, then (int32 exponent,
+    // raw coefficient) pairs in ascending exponent order, in native byte order
+    void serialize(std::string& out) const {
+        static_assert(std::is_trivially_copyable_v<Coeff>, "Binary format needs trivially copyable coefficients");
+        uint64_t count = 0;
+        for (const auto& term : terms) count += live(term.second);
+        size_t offset = out.size();
+        out.resize(offset + 4 + sizeof(count) + count * (sizeof(int32_t) + sizeof(Coeff)));
+        char* dst = &out[offset];
+        std::memcpy(dst, "PLY1", 4);
+        std::memcpy(dst + 4, &count, sizeof(count));
+        dst += 4 + sizeof(count);
+        for (const auto& [exp, coeff] : terms) {
+            if (!live(coeff)) continue;
+            int32_t e = exp;
+            std::memcpy(dst, &e, sizeof(e));
+            std::memcpy(dst + sizeof(e), &coeff, sizeof(Coeff));
+            dst += sizeof(e) + sizeof(Coeff);
+        }
+    }
+
+    static Polynomial deserialize(std::string_view bytes) {
+        static_assert(std::is_trivially_copyable_v<Coeff>, "Binary format needs trivially copyable coefficients");
+        const size_t header = 4 + sizeof(uint64_t), record = sizeof(int32_t) + sizeof(Coeff);
+        uint64_t count = 0;
+        if (bytes.size() < header || std::memcmp(bytes.data(), "PLY1", 4) != 0) {
+            throw std::invalid_argument("Not a serialized polynomial");
+        }
+        std::memcpy(&count, bytes.data() + 4, sizeof(count));
+        if ((bytes.size() - header) / record < count) throw std::invalid_argument("Truncated polynomial data");
+
+        Polynomial result;
+        const char* src = bytes.data() + header;
+        for (uint64_t i = 0; i < count; ++i, src += record) {
+            int32_t exp;
+            Coeff coeff;
+            std::memcpy(&exp, src, sizeof(exp));
+            std::memcpy(&coeff, src + sizeof(exp), sizeof(Coeff));
+            if (!result.terms.empty() && exp <= result.terms.rbegin()->first) {
+                throw std::invalid_argument("Exponents out of order in polynomial data");
+            }
+            result.terms.emplace_hint(result.terms.end(), exp, coeff);
+        }
+        return result;
+    }
 };
 
 // Example usage:
 int main() {
-    Polynomial p1 = {3, 0, -4}; // 3 - 4x^2
-    Polynomial p2 = {1, 2};     // 1 + 2x
+    Polynomial<double> p1 = {3, 0, -4}; // 3 - 4x^2
+    Polynomial<double> p2 = {1, 2};     // 1 + 2x
 
-    Polynomial p3 = p1 + p2;    // Polynomial addition
-    Polynomial p4 = p1 * p2;    // Polynomial multiplication
+    Polynomial<double> p3 = p1 + p2;    // Polynomial addition
+    Polynomial<double> p4 = p1 * p2;    // Polynomial multiplication
 
     std::cout << "p1: " << p1 << "\n";
     std::cout << "p2: " << p2 << "\n";
@@ -208,5 +1015,71 @@ int main() {
     std::cout << "Derivative of p1: " << p1.derivative() << "\n";
     std::cout << "Integral of p1: " << p1.integral() << "\n";
 
+    // Accumulate in place; zero terms stay until normalize() and are skipped when printed or compared
+    Polynomial<double> sum;
+    for (int i = 0; i < 1000; ++i) {
+        sum += p2;
+        sum -= p2;
+    }
+    sum += p1;
+    sum *= p2;
+    std::cout << "Accumulated (p1 * p2): " << sum << "\n";
+    std::cout << "Matches p1 * p2: " << std::boolalpha << (sum == p4) << "\n";
+
+    // Compiled evaluation for hot loops
+    CompiledPolynomial<double> fast = p4.compile();
+    std::vector<double> xs = {0, 0.5, 1, 2}, ys(xs.size());
+    fast.evaluate(xs.data(), ys.data(), xs.size());
+    std::cout << "p1 * p2 compiled at 0, 0.5, 1, 2:";
+    for (double y : ys) std::cout << " " << y;
+    std::cout << "\n";
+
+    // Fixed degree known at compile time
+    constexpr StaticPolynomial<2> quadratic(3, 0, -4); // 3 - 4x^2
+    static_assert(quadratic(2) == -13, "evaluated at compile time");
+    static_assert(quadratic.derivative()(1) == -8, "derivative at compile time");
+    std::cout << "StaticPolynomial<2> at 2: " << quadratic(2) << "\n";
+
+    // Text and binary round trips, with throughput for a large polynomial
+    Polynomial<double> parsed = Polynomial<double>::parse("2.5x^3 - x + 1");
+    std::cout << "Parsed: " << parsed << " (degree " << parsed.degree() << ")\n";
+
+    Polynomial<double> big;
+    for (int i = 0; i < 200000; ++i) big[i] = (i % 7 - 3) * 0.25 + 1.0 / (i + 1);
+    auto seconds = [](auto start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::string text = big.toString();
+    double formatTime = seconds(start);
+    start = std::chrono::steady_clock::now();
+    Polynomial<double> fromText = Polynomial<double>::parse(text);
+    double parseTime = seconds(start);
+    std::string binary;
+    start = std::chrono::steady_clock::now();
+    big.serialize(binary);
+    double writeTime = seconds(start);
+    start = std::chrono::steady_clock::now();
+    Polynomial<double> fromBinary = Polynomial<double>::deserialize(binary);
+    double readTime = seconds(start);
+
+    double textMB = text.size() / 1e6, binaryMB = binary.size() / 1e6;
+    std::cout << "Text: " << textMB << " MB, format " << textMB / formatTime << " MB/s, parse "
+              << textMB / parseTime << " MB/s, round trip " << (fromText == big ? "ok" : "FAILED") << "\n";
+    std::cout << "Binary: " << binaryMB << " MB, write " << binaryMB / writeTime << " MB/s, read "
+              << binaryMB / readTime << " MB/s, round trip " << (fromBinary == big ? "ok" : "FAILED") << "\n";
+
+    // Complex coefficients
+    using C = std::complex<double>;
+    Polynomial<C> c1 = {C(1, 1), C(0, 2)}; // (1+i) + 2i x
+    std::cout << "c1 * c1: " << c1 * c1 << "\n";
+
+    // Exact modular coefficients; (1 + x)^256 is multiplied via NTT
+    using Mod = ModInt<998244353>;
+    Polynomial<Mod> binomial = {1, 1};
+    for (int i = 0; i < 8; ++i) binomial *= binomial;
+    std::cout << "C(256, 128) mod 998244353: " << binomial[128] << "\n";
+    std::cout << "Degree of (1 + x)^256: " << binomial.degree() << "\n";
+
     return 0;
 }
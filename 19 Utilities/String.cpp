@@ -1,218 +1,2401 @@
 #include <iostream>
+#include <fstream>
 #include <cstring>
 #include <stdexcept>
 #include <cctype>
 #include <vector>
-#include <sstream>
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <string>
+#include <memory>
+#include <iterator>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <memory_resource>
+#include <thread>
+#include <optional>
+#include <initializer_list>
+#include <cstdio>
+#include <locale>
+#include <limits>
+#include <filesystem>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define STRING_HAVE_SSSE3_DISPATCH 1
+#endif
+
+// Precompiled substring search over byte ranges.
+// Needles of up to SHORT_NEEDLE bytes are found by comparing their first and last byte
+// against 16 haystack positions at once (SSE2, with a scalar fallback) and verifying the
+// candidates. Longer needles use the Two-Way algorithm (Crochemore-Perrin) combined with
+// a last-byte shift table, which is linear in the worst case and sublinear on typical text.
+class Searcher {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    static constexpr size_t SHORT_NEEDLE = 16;
+
+private:
+    std::string needle;
+    size_t criticalPos = 0;  // Two-Way: end of the left half of the critical factorization
+    size_t period = 1;       // Two-Way: shift after a full right-half match
+    size_t memory = 0;       // Two-Way: prefix known to match after a periodic shift (0 if aperiodic)
+    size_t shift[256] = {};  // Last position + 1 of each byte in the needle (0 if absent)
+
+    // Maximal suffix of the needle under < (or > when reversed); returns its start - 1
+    // (wrapping) and sets p to its period.
+    size_t maximalSuffix(bool reversed, size_t& p) const {
+        const unsigned char* n = reinterpret_cast<const unsigned char*>(needle.data());
+        size_t l = needle.size();
+        size_t ip = npos, jp = 0, k = 1;
+        p = 1;
+        while (jp + k < l) {
+            unsigned char a = n[ip + k], b = n[jp + k];
+            if (a == b) {
+                if (k == p) {
+                    jp += p;
+                    k = 1;
+                } else {
+                    ++k;
+                }
+            } else if (reversed ? a < b : a > b) {
+                jp += k;
+                k = 1;
+                p = jp - ip;
+            } else {
+                ip = jp++;
+                k = p = 1;
+            }
+        }
+        return ip;
+    }
+
+    static size_t findShort(const char* h, size_t n, const char* nd, size_t m, size_t pos) {
+        if (m == 1) {
+            const void* hit = std::memchr(h + pos, nd[0], n - pos);
+            return hit ? static_cast<const char*>(hit) - h : npos;
+        }
+        size_t i = pos;
+#if defined(__SSE2__)
+        const __m128i first = _mm_set1_epi8(nd[0]);
+        const __m128i last = _mm_set1_epi8(nd[m - 1]);
+        for (; i + m + 15 <= n; i += 16) {
+            __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+            __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + m - 1));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast))));
+            while (mask) {
+                unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+                if (std::memcmp(h + i + bit + 1, nd + 1, m - 2) == 0) return i + bit;
+                mask &= mask - 1;
+            }
+        }
+#endif
+        while (i + m <= n) {
+            const void* hit = std::memchr(h + i, nd[0], n - m + 1 - i);
+            if (!hit) return npos;
+            i = static_cast<const char*>(hit) - h;
+            if (h[i + m - 1] == nd[m - 1] && std::memcmp(h + i + 1, nd + 1, m - 2) == 0) return i;
+            ++i;
+        }
+        return npos;
+    }
+
+    // Two-Way scan from window pos. With Backward set, the haystack is read from its end,
+    // so a needle stored reversed finds the last match; positions count from the end too.
+    template <bool Backward>
+    size_t findTwoWay(const char* hay, size_t n, size_t pos) const {
+        const unsigned char* base = reinterpret_cast<const unsigned char*>(hay);
+        const unsigned char* nd = reinterpret_cast<const unsigned char*>(needle.data());
+        auto at = [base, n](size_t i) { return Backward ? base[n - 1 - i] : base[i]; };
+        size_t l = needle.size(), mem = 0;
+        for (size_t i = pos; n - i >= l;) {
+            // Check the last byte first and skip ahead on a mismatch
+            size_t s = shift[at(i + l - 1)];
+            if (s == 0) {
+                i += l;
+                mem = 0;
+                continue;
+            }
+            if (s != l) {
+                i += std::max(l - s, mem);
+                mem = 0;
+                continue;
+            }
+            // Compare the right half, then the left half
+            size_t k = std::max(criticalPos + 1, mem);
+            while (k < l && nd[k] == at(i + k)) ++k;
+            if (k < l) {
+                i += k - criticalPos;
+                mem = 0;
+                continue;
+            }
+            for (k = criticalPos + 1; k > mem && nd[k - 1] == at(i + k - 1); --k) {}
+            if (k <= mem) return i;
+            i += period;
+            mem = memory;
+        }
+        return npos;
+    }
+
+public:
+    // Precompute the search state for a needle
+    Searcher(const char* str, size_t length) : needle(str, length) {
+        if (length <= SHORT_NEEDLE) return;
+        for (size_t i = 0; i < length; ++i) shift[static_cast<unsigned char>(str[i])] = i + 1;
+
+        // Critical factorization: the later of the two maximal suffixes
+        size_t p0, p1;
+        size_t ms = maximalSuffix(false, p0);
+        size_t ms1 = maximalSuffix(true, p1);
+        if (ms1 + 1 > ms + 1) {
+            ms = ms1;
+            period = p1;
+        } else {
+            period = p0;
+        }
+        criticalPos = ms;
+
+        if (std::memcmp(str, str + period, ms + 1) != 0) {
+            memory = 0;
+            period = std::max(ms, length - ms - 1) + 1;
+        } else {
+            memory = length - period;
+        }
+    }
+
+    explicit Searcher(const char* str) : Searcher(str, std::strlen(str)) {}
+
+    // Any string type providing c_str() and length()
+    template <typename Str, typename = decltype(std::declval<const Str&>().c_str())>
+    explicit Searcher(const Str& str) : Searcher(str.c_str(), str.length()) {}
+
+    size_t length() const { return needle.size(); }
+
+    // First occurrence at or after pos in hay[0, n), or npos
+    size_t find(const char* hay, size_t n, size_t pos = 0) const {
+        size_t m = needle.size();
+        if (pos > n || n - pos < m) return npos;
+        if (m == 0) return pos;
+        if (m <= SHORT_NEEDLE) return findShort(hay, n, needle.data(), m, pos);
+        return findTwoWay<false>(hay, n, pos);
+    }
+
+    template <typename Str, typename = decltype(std::declval<const Str&>().c_str())>
+    size_t find(const Str& hay, size_t pos = 0) const {
+        return find(hay.c_str(), hay.length(), pos);
+    }
+
+    // One-off search without keeping a Searcher; needles up to SHORT_NEEDLE bytes
+    // (such as delimiters) need no setup and no allocation
+    static size_t findOnce(const char* hay, size_t n, const char* nd, size_t m, size_t pos = 0) {
+        if (pos > n || n - pos < m) return npos;
+        if (m == 0) return pos;
+        if (m <= SHORT_NEEDLE) return findShort(hay, n, nd, m, pos);
+        return Searcher(nd, m).find(hay, n, pos);
+    }
+
+    // Last occurrence starting at or before pos in hay[0, n), or npos
+    size_t rfind(const char* hay, size_t n, size_t pos = npos) const {
+        return rfindOnce(hay, n, needle.data(), needle.size(), pos);
+    }
+
+    // Short needles are scanned backwards directly; longer ones run Two-Way with the
+    // needle and haystack both reversed, which keeps the worst case linear
+    static size_t rfindOnce(const char* hay, size_t n, const char* nd, size_t m, size_t pos = npos) {
+        if (m > n) return npos;
+        size_t i = std::min(pos, n - m);
+        if (m == 0) return i;
+        if (m > SHORT_NEEDLE) {
+            std::string reversed(std::make_reverse_iterator(nd + m), std::make_reverse_iterator(nd));
+            size_t r = Searcher(reversed.data(), m).findTwoWay<true>(hay, n, n - m - i);
+            return r == npos ? npos : n - m - r;
+        }
+        for (;;) {
+            if (hay[i] == nd[0] && hay[i + m - 1] == nd[m - 1] && std::memcmp(hay + i, nd, m) == 0) {
+                return i;
+            }
+            if (i == 0) return npos;
+            --i;
+        }
+    }
+
+    // Forward iterator over the start of every (possibly overlapping) match
+    class MatchIterator {
+    private:
+        const Searcher* searcher;
+        const char* hay;
+        size_t n;
+        size_t pos;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const size_t*;
+        using reference = size_t;
+
+        MatchIterator(const Searcher* s, const char* h, size_t count, size_t start)
+            : searcher(s), hay(h), n(count), pos(start == npos ? npos : s->find(h, count, start)) {}
+
+        size_t operator*() const { return pos; }
+
+        MatchIterator& operator++() {
+            pos = searcher->find(hay, n, pos + 1);
+            return *this;
+        }
+
+        MatchIterator operator++(int) {
+            MatchIterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const MatchIterator& other) const { return pos == other.pos; }
+        bool operator!=(const MatchIterator& other) const { return pos != other.pos; }
+    };
+
+    // Range of all matches in a haystack; may own the searcher it uses
+    class Matches {
+    private:
+        std::unique_ptr<Searcher> owned;
+        const Searcher* searcher;
+        const char* hay;
+        size_t n;
+
+    public:
+        Matches(const Searcher* s, const char* h, size_t count) : searcher(s), hay(h), n(count) {}
+        Matches(std::unique_ptr<Searcher> s, const char* h, size_t count)
+            : owned(std::move(s)), searcher(owned.get()), hay(h), n(count) {}
+
+        MatchIterator begin() const { return MatchIterator(searcher, hay, n, 0); }
+        MatchIterator end() const { return MatchIterator(searcher, hay, n, npos); }
+    };
+
+    Matches findAll(const char* hay, size_t n) const {
+        return Matches(this, hay, n);
+    }
+
+    template <typename Str, typename = decltype(std::declval<const Str&>().c_str())>
+    Matches findAll(const Str& hay) const {
+        return Matches(this, hay.c_str(), hay.length());
+    }
+};
+
+// Fast non-cryptographic hash of a byte range, in the style of wyhash: inputs are consumed
+// 8 or 16 bytes at a time and mixed with 64x64->128-bit multiplications.
+inline uint64_t hashBytes(const char* str, size_t n, uint64_t seed = 0) {
+    const uint64_t s0 = 0xa0761d6478bd642full, s1 = 0xe7037ed1a0b428dbull;
+    const uint64_t s2 = 0x8ebc6af09c88c6e3ull, s3 = 0x589965cc75374cc3ull;
+    auto multiply = [](uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+        a = static_cast<uint64_t>(r);
+        b = static_cast<uint64_t>(r >> 64);
+#else
+        uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+        uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32);
+        uint64_t lo = t + (rm1 << 32);
+        uint64_t carry = (t < rl) + (lo < t);
+        b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+        a = lo;
+#endif
+    };
+    auto mix = [&](uint64_t a, uint64_t b) {
+        multiply(a, b);
+        return a ^ b;
+    };
+    auto read64 = [](const unsigned char* p) { uint64_t v; std::memcpy(&v, p, 8); return v; };
+    auto read32 = [](const unsigned char* p) { uint32_t v; std::memcpy(&v, p, 4); return static_cast<uint64_t>(v); };
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(str);
+    seed ^= mix(seed ^ s0, s1);
+    uint64_t a, b;
+    if (n <= 16) {
+        if (n >= 4) {
+            size_t step = (n >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + step);
+            b = (read32(p + n - 4) << 32) | read32(p + n - 4 - step);
+        } else if (n > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[n >> 1]) << 8) | p[n - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = n;
+        if (i > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = mix(read64(p) ^ s1, read64(p + 8) ^ seed);
+                seed1 = mix(read64(p + 16) ^ s2, read64(p + 24) ^ seed1);
+                seed2 = mix(read64(p + 32) ^ s3, read64(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (i > 16) {
+            seed = mix(read64(p) ^ s1, read64(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+    a ^= s1;
+    b ^= seed;
+    multiply(a, b);
+    return mix(a ^ s0 ^ n, b ^ s1);
+}
+
+// Non-owning, read-only view of a character range (not necessarily null-terminated).
+class StringView {
+private:
+    const char* ptr;
+    size_t len;
+
+public:
+    static constexpr size_t npos = Searcher::npos;
+
+    // Constructors
+    constexpr StringView() : ptr(""), len(0) {}
+    constexpr StringView(const char* str, size_t count) : ptr(str), len(count) {}
+    StringView(const char* str) : ptr(str), len(std::strlen(str)) {}
+
+    const char* data() const { return ptr; }
+    size_t length() const { return len; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+
+    const char* begin() const { return ptr; }
+    const char* end() const { return ptr + len; }
+
+    const char& operator[](size_t index) const {
+        if (index >= len) {
+            throw std::out_of_range("Index out of range");
+        }
+        return ptr[index];
+    }
+
+    // Sub-view; count is clamped to the end
+    StringView substr(size_t start, size_t count = npos) const {
+        if (start > len) throw std::out_of_range("Index out of range");
+        return StringView(ptr + start, std::min(count, len - start));
+    }
+
+    size_t find(StringView needle, size_t pos = 0) const {
+        return Searcher::findOnce(ptr, len, needle.ptr, needle.len, pos);
+    }
+
+    // Comparison operators
+    bool operator==(StringView other) const {
+        return len == other.len && std::memcmp(ptr, other.ptr, len) == 0;
+    }
+
+    bool operator!=(StringView other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(StringView other) const {
+        int cmp = std::memcmp(ptr, other.ptr, std::min(len, other.len));
+        return cmp < 0 || (cmp == 0 && len < other.len);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, StringView view) {
+        return os.write(view.ptr, static_cast<std::streamsize>(view.len));
+    }
+};
+
+// Lazy split of a StringView into views. Nothing is copied or allocated: each step scans
+// for the next delimiter (memchr for a single character, the short-needle search for a
+// delimiter sequence, a 256-bit table for a set of delimiter characters).
+// n delimiters always produce n + 1 pieces, including empty ones.
+class SplitRange {
+public:
+    enum class Mode { Char, Sequence, AnyOf };
+
+private:
+    StringView text;
+    Mode mode;
+    char ch = 0;
+    StringView delim;
+    uint64_t set[4] = {};
+
+    bool inSet(unsigned char c) const {
+        return (set[c >> 6] >> (c & 63)) & 1;
+    }
+
+    // Position of the next delimiter at or after pos (text.length() if none) and its length
+    size_t next(size_t pos, size_t& delimLength) const {
+        const char* p = text.data();
+        size_t n = text.length();
+        switch (mode) {
+            case Mode::Char: {
+                delimLength = 1;
+                const void* hit = std::memchr(p + pos, ch, n - pos);
+                return hit ? static_cast<const char*>(hit) - p : n;
+            }
+            case Mode::Sequence: {
+                delimLength = delim.length();
+                if (delimLength == 0) return n;
+                size_t hit = Searcher::findOnce(p, n, delim.data(), delimLength, pos);
+                return hit == Searcher::npos ? n : hit;
+            }
+            case Mode::AnyOf:
+                delimLength = 1;
+                while (pos < n && !inSet(static_cast<unsigned char>(p[pos]))) ++pos;
+                return pos;
+        }
+        return n;
+    }
+
+public:
+    SplitRange(StringView str, char delimiter) : text(str), mode(Mode::Char), ch(delimiter) {}
+
+    SplitRange(StringView str, StringView delimiter, Mode m = Mode::Sequence) : text(str), mode(m), delim(delimiter) {
+        if (mode == Mode::AnyOf) {
+            for (char c : delimiter) {
+                unsigned char u = static_cast<unsigned char>(c);
+                set[u >> 6] |= uint64_t(1) << (u & 63);
+            }
+        }
+    }
+
+    class iterator {
+    private:
+        const SplitRange* range;
+        size_t start;     // Start of the current piece (npos once past the last piece)
+        size_t stop;      // End of the current piece
+        size_t delimLength;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = StringView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const StringView*;
+        using reference = StringView;
+
+        iterator(const SplitRange* r, size_t pos) : range(r), start(pos), stop(0), delimLength(0) {
+            if (start != StringView::npos) stop = range->next(start, delimLength);
+        }
+
+        StringView operator*() const {
+            return StringView(range->text.data() + start, stop - start);
+        }
+
+        iterator& operator++() {
+            if (stop >= range->text.length()) {
+                start = StringView::npos;
+            } else {
+                start = stop + delimLength;
+                stop = range->next(start, delimLength);
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const iterator& other) const { return start == other.start; }
+        bool operator!=(const iterator& other) const { return start != other.start; }
+    };
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, StringView::npos); }
+};
+
+// UTF-8 primitives over byte ranges. ASCII runs are processed 16 bytes at a time (SSE2);
+// multi-byte sequences are checked against the well-formed byte sequences of Unicode
+// Table 3-7 (no overlongs, surrogates or code points above U+10FFFF).
+class Utf8 {
+public:
+    static constexpr char32_t REPLACEMENT = 0xFFFD;
+
+    // True if the range is well-formed UTF-8
+    static bool validate(const char* str, size_t n) {
+#if defined(STRING_HAVE_SSSE3_DISPATCH)
+        static const bool ssse3 = __builtin_cpu_supports("ssse3");
+        if (ssse3) return validateSsse3(str, n);
+#endif
+        return validateScalar(str, n);
+    }
+
+    // ASCII runs 16 bytes at a time, then one multi-byte sequence at a time
+    static bool validateScalar(const char* str, size_t n) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(str);
+        const unsigned char* end = p + n;
+        while (p < end) {
+#if defined(__SSE2__)
+            while (end - p >= 16 && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) == 0) p += 16;
+            if (p == end) break;
+#endif
+            if (*p < 0x80) {
+                ++p;
+                continue;
+            }
+            size_t extra = sequenceLength(p, end) - 1;
+            if (extra == 0) return false;
+            p += extra + 1;
+        }
+        return true;
+    }
+
+    // Number of code points (bytes that are not continuation bytes)
+    static size_t countCodePoints(const char* str, size_t n) {
+        size_t count = 0, i = 0;
+#if defined(__SSE2__)
+        const __m128i lastContinuation = _mm_set1_epi8(static_cast<char>(0xC0)); // 0x80..0xBF are below it as signed
+        for (; i + 16 <= n; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+            unsigned continuation = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmplt_epi8(block, lastContinuation)));
+            count += 16 - static_cast<size_t>(__builtin_popcount(continuation));
+        }
+#endif
+        for (; i < n; ++i) count += (static_cast<unsigned char>(str[i]) & 0xC0) != 0x80;
+        return count;
+    }
+
+    // Decode the code point at p and advance past it. Malformed input yields REPLACEMENT
+    // and advances by one byte, so decoding never reads past end.
+    static char32_t decode(const char*& str, const char* end) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(str);
+        if (*p < 0x80) {
+            ++str;
+            return *p;
+        }
+        size_t length = sequenceLength(p, reinterpret_cast<const unsigned char*>(end));
+        if (length == 1) {
+            ++str;
+            return REPLACEMENT;
+        }
+        str += length;
+        if (length == 2) return ((p[0] & 0x1Fu) << 6) | (p[1] & 0x3Fu);
+        if (length == 3) return ((p[0] & 0x0Fu) << 12) | ((p[1] & 0x3Fu) << 6) | (p[2] & 0x3Fu);
+        return ((p[0] & 0x07u) << 18) | ((p[1] & 0x3Fu) << 12) | ((p[2] & 0x3Fu) << 6) | (p[3] & 0x3Fu);
+    }
+
+    // Encode cp into out (room for 4 bytes), returning the number of bytes written
+    static size_t encode(char32_t cp, char* out) {
+        if (cp < 0x80) {
+            out[0] = static_cast<char>(cp);
+            return 1;
+        }
+        if (cp < 0x800) {
+            out[0] = static_cast<char>(0xC0 | (cp >> 6));
+            out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+            return 2;
+        }
+        if (cp < 0x10000) {
+            out[0] = static_cast<char>(0xE0 | (cp >> 12));
+            out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+            return 3;
+        }
+        out[0] = static_cast<char>(0xF0 | (cp >> 18));
+        out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 4;
+    }
+
+    // Byte offset just past the next code point starting at or after pos
+    static size_t next(const char* str, size_t n, size_t pos) {
+        ++pos;
+        while (pos < n && (static_cast<unsigned char>(str[pos]) & 0xC0) == 0x80) ++pos;
+        return pos;
+    }
+
+    // Forward iteration over the code points of a byte range
+    class CodePoints {
+    private:
+        const char* first;
+        const char* last;
+
+    public:
+        class iterator {
+        private:
+            const char* pos;
+            const char* next; // Start of the following code point
+            const char* end;
+            char32_t value;
+
+            void load() {
+                next = pos;
+                if (pos != end) value = decode(next, end);
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = char32_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const char32_t*;
+            using reference = char32_t;
+
+            iterator(const char* p, const char* e) : pos(p), next(p), end(e), value(0) {
+                load();
+            }
+
+            char32_t operator*() const {
+                return value;
+            }
+
+            iterator& operator++() {
+                pos = next;
+                load();
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            // Address of the current code point's first byte
+            const char* position() const { return pos; }
+
+            bool operator==(const iterator& other) const { return pos == other.pos; }
+            bool operator!=(const iterator& other) const { return pos != other.pos; }
+        };
+
+        CodePoints(const char* str, size_t n) : first(str), last(str + n) {}
+
+        iterator begin() const { return iterator(first, last); }
+        iterator end() const { return iterator(last, last); }
+    };
+
+private:
+#if defined(STRING_HAVE_SSSE3_DISPATCH)
+    // Lookup-table validation (Keiser & Lemire, "Validating UTF-8 In Less Than One
+    // Instruction Per Byte"): three 16-entry shuffles classify every pair of adjacent bytes,
+    // and a carry from the bytes two and three positions back checks sequence lengths.
+    // Blocks of pure ASCII only need the previous block to have ended cleanly.
+    __attribute__((target("ssse3"))) static bool validateSsse3(const char* str, size_t n) {
+        constexpr char TOO_SHORT = 1 << 0, TOO_LONG = 1 << 1, OVERLONG_3 = 1 << 2, TOO_LARGE = 1 << 3;
+        constexpr char SURROGATE = 1 << 4, OVERLONG_2 = 1 << 5, TOO_LARGE_1000 = 1 << 6, OVERLONG_4 = 1 << 6;
+        constexpr char TWO_CONTS = static_cast<char>(1 << 7);
+        constexpr char CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+        const __m128i byte1High = _mm_setr_epi8(
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+            TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+            TOO_SHORT | OVERLONG_2, TOO_SHORT, TOO_SHORT | OVERLONG_3 | SURROGATE,
+            TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+        const __m128i byte1Low = _mm_setr_epi8(
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2, CARRY, CARRY,
+            CARRY | TOO_LARGE, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000);
+        const __m128i byte2High = _mm_setr_epi8(
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+        // Saturating subtraction leaves a non-zero byte where a sequence is still open at the end
+        const __m128i incompleteLimit = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                      static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1),
+                                                      static_cast<char>(0xC0 - 1));
+        const __m128i lowNibble = _mm_set1_epi8(0x0F);
+
+        __m128i error = _mm_setzero_si128(), previous = _mm_setzero_si128(), incomplete = _mm_setzero_si128();
+        for (size_t i = 0; i < n; i += 16) {
+            __m128i input;
+            if (i + 16 <= n) {
+                input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+            } else {
+                alignas(16) char tail[16] = {}; // Zero padding makes a truncated sequence TOO_SHORT
+                std::memcpy(tail, str + i, n - i);
+                input = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+            }
+            if (_mm_movemask_epi8(input) == 0) {
+                error = _mm_or_si128(error, incomplete);
+                incomplete = _mm_setzero_si128();
+            } else {
+                __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+                __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+                __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+                __m128i special = _mm_and_si128(
+                    _mm_and_si128(_mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), lowNibble)),
+                                  _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, lowNibble))),
+                    _mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(input, 4), lowNibble)));
+                __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+                __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+                __m128i mustContinue = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+                error = _mm_or_si128(error, _mm_xor_si128(mustContinue, special));
+                incomplete = _mm_subs_epu8(input, incompleteLimit);
+            }
+            previous = input;
+        }
+        error = _mm_or_si128(error, incomplete);
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+    }
+#endif
+
+    // Length of the well-formed sequence starting with the non-ASCII byte at p, or 1 if
+    // it is malformed or truncated.
+    static size_t sequenceLength(const unsigned char* p, const unsigned char* end) {
+        unsigned char lead = *p;
+        size_t length;
+        unsigned char low = 0x80, high = 0xBF; // Allowed range of the second byte
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            if (lead == 0xE0) low = 0xA0;       // Overlong
+            else if (lead == 0xED) high = 0x9F; // Surrogates
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            if (lead == 0xF0) low = 0x90;       // Overlong
+            else if (lead == 0xF4) high = 0x8F; // Above U+10FFFF
+        } else {
+            return 1;
+        }
+        if (static_cast<size_t>(end - p) < length || p[1] < low || p[1] > high) return 1;
+        for (size_t i = 2; i < length; ++i) {
+            if ((p[i] & 0xC0) != 0x80) return 1;
+        }
+        return length;
+    }
+};
+
+// Sparse code point index over UTF-8 text: records the byte offset of every STRIDE-th
+// code point, so locating code point i costs one lookup and at most STRIDE - 1 steps.
+// The text must outlive the index.
+class Utf8Index {
+private:
+    static constexpr size_t STRIDE = 64;
+
+    StringView text;
+    std::vector<size_t> checkpoints;
+    size_t count = 0;
+
+public:
+    static constexpr size_t npos = StringView::npos;
+
+    explicit Utf8Index(StringView str) : text(str) {
+        const char* p = text.data();
+        size_t n = text.length(), i = 0;
+        checkpoints.reserve(n / STRIDE + 1);
+        size_t nextCheckpoint = 0; // Code point number that needs the next checkpoint
+#if defined(__SSE2__)
+        const __m128i lastContinuation = _mm_set1_epi8(static_cast<char>(0xC0));
+        for (; i + 16 <= n; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            unsigned leading = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmplt_epi8(block, lastContinuation))) & 0xFFFF;
+            size_t k = static_cast<size_t>(__builtin_popcount(leading));
+            if (count + k > nextCheckpoint) {
+                for (unsigned bits = leading; bits; bits &= bits - 1, ++count) {
+                    if (count == nextCheckpoint) {
+                        checkpoints.push_back(i + static_cast<size_t>(__builtin_ctz(bits)));
+                        nextCheckpoint += STRIDE;
+                    }
+                }
+            } else {
+                count += k;
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            if ((static_cast<unsigned char>(p[i]) & 0xC0) == 0x80) continue;
+            if (count == nextCheckpoint) {
+                checkpoints.push_back(i);
+                nextCheckpoint += STRIDE;
+            }
+            ++count;
+        }
+    }
+
+    // Number of code points
+    size_t size() const {
+        return count;
+    }
+
+    // Byte offset of code point index (the text length for index == size())
+    size_t byteOffset(size_t index) const {
+        if (index >= count) {
+            if (index == count) return text.length();
+            throw std::out_of_range("Code point index out of range");
+        }
+        size_t pos = checkpoints[index / STRIDE];
+        for (size_t steps = index % STRIDE; steps; --steps) pos = Utf8::next(text.data(), text.length(), pos);
+        return pos;
+    }
+
+    char32_t operator[](size_t index) const {
+        const char* p = text.data() + byteOffset(index);
+        return Utf8::decode(p, text.data() + text.length());
+    }
+
+    // View of n code points starting at code point start
+    StringView substr(size_t start, size_t n = npos) const {
+        size_t first = byteOffset(start);
+        size_t last = n >= count - start ? text.length() : byteOffset(start + n);
+        return text.substr(first, last - first);
+    }
+};
 
 class String {
+public:
+    static constexpr size_t npos = Searcher::npos;
+
+    // Strings up to this many characters are stored inside the object itself.
+    static constexpr size_t INLINE_CAPACITY = 23;
+
+private:
+    char* data;      // Points at `local` for short strings, otherwise at a heap buffer.
+    size_t len;      // Length of the string.
+    std::pmr::memory_resource* resource; // Source of heap buffers (nullptr: global new[]/delete[]).
+    union {
+        size_t heapCapacity;               // Heap buffer size in characters, excluding the terminator.
+        char local[INLINE_CAPACITY + 1];   // Inline storage for short strings (small-string optimization).
+    };
+
+    static inline thread_local std::pmr::memory_resource* threadResource = nullptr; // Default for new Strings
+    static inline thread_local size_t allocations = 0; // Heap buffers allocated on this thread (for benchmarking).
+
+    bool isInline() const {
+        return data == local;
+    }
+
+    // Whitespace as classified by std::isspace in the "C" locale
+    static bool isSpace(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    // Simple one-to-one case mapping for the two-byte UTF-8 ranges whose upper and lower
+    // case forms have the same encoded length: Latin-1 Supplement, Greek and Cyrillic.
+    static uint32_t mapCase(uint32_t cp, bool upper) {
+        if (upper) {
+            if (cp >= 0xE0 && cp <= 0xFE && cp != 0xF7) return cp - 0x20;
+            if (cp >= 0x3B1 && cp <= 0x3C9 && cp != 0x3C2) return cp - 0x20;
+            if (cp >= 0x430 && cp <= 0x44F) return cp - 0x20;
+            if (cp >= 0x450 && cp <= 0x45F) return cp - 0x50;
+        } else {
+            if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) return cp + 0x20;
+            if (cp >= 0x391 && cp <= 0x3A9 && cp != 0x3A2) return cp + 0x20;
+            if (cp >= 0x410 && cp <= 0x42F) return cp + 0x20;
+            if (cp >= 0x400 && cp <= 0x40F) return cp + 0x50;
+        }
+        return cp;
+    }
+
+    // Case-map the non-ASCII characters of a UTF-8 buffer in place; bytes that are not
+    // part of a valid two-byte sequence are left untouched.
+    static void convertCaseUtf8(char* str, size_t n, bool upper) {
+        unsigned char* p = reinterpret_cast<unsigned char*>(str);
+        for (size_t i = 0; i < n; ++i) {
+            if (p[i] < 0xC2 || p[i] > 0xDF || i + 1 >= n || (p[i + 1] & 0xC0) != 0x80) continue;
+            uint32_t cp = ((p[i] & 0x1Fu) << 6) | (p[i + 1] & 0x3Fu);
+            uint32_t mapped = mapCase(cp, upper);
+            p[i] = static_cast<unsigned char>(0xC0 | (mapped >> 6));
+            p[i + 1] = static_cast<unsigned char>(0x80 | (mapped & 0x3F));
+            ++i;
+        }
+    }
+
+    // Convert case in place: ASCII letters 16 bytes at a time (SSE2), then a UTF-8 pass
+    // only if the buffer contained any non-ASCII byte. Non-ASCII bytes are negative as
+    // signed chars, so the ASCII range checks never touch them.
+    static void convertCase(char* p, size_t n, bool upper) {
+        const char first = upper ? 'a' : 'A', last = upper ? 'z' : 'Z';
+        unsigned nonAscii = 0;
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i below = _mm_set1_epi8(static_cast<char>(first - 1));
+        const __m128i above = _mm_set1_epi8(static_cast<char>(last + 1));
+        const __m128i flip = _mm_set1_epi8(0x20);
+        for (; i + 16 <= n; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            nonAscii |= static_cast<unsigned>(_mm_movemask_epi8(block));
+            __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(block, below), _mm_cmplt_epi8(block, above));
+            block = _mm_xor_si128(block, _mm_and_si128(letters, flip));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i), block);
+        }
+#endif
+        for (; i < n; ++i) {
+            nonAscii |= static_cast<unsigned char>(p[i]) & 0x80;
+            if (p[i] >= first && p[i] <= last) p[i] ^= 0x20;
+        }
+        if (nonAscii) convertCaseUtf8(p, n, upper);
+    }
+
+    void requireValidUtf8() const {
+        if (!Utf8::validate(data, len)) throw std::runtime_error("Invalid UTF-8");
+    }
+
+    char* allocate(size_t chars) {
+        ++allocations;
+        if (!resource) return new char[chars + 1];
+        return static_cast<char*>(resource->allocate(chars + 1, 1));
+    }
+
+    void deallocate(char* buffer, size_t chars) {
+        if (!resource) delete[] buffer;
+        else resource->deallocate(buffer, chars + 1, 1);
+    }
+
+    void release() {
+        if (!isInline()) deallocate(data, heapCapacity);
+    }
+
+    // Make room for at least `chars` characters without changing the contents.
+    void reserveExact(size_t chars) {
+        if (chars <= capacity()) return;
+        char* newData = allocate(chars);
+        std::memcpy(newData, data, len + 1);
+        release();
+        data = newData;
+        heapCapacity = chars;
+    }
+
+    // Make room for at least `chars` characters, at least doubling the capacity so that
+    // repeated appends are amortized O(1).
+    void grow(size_t chars) {
+        reserveExact(std::max(chars, capacity() * 2));
+    }
+
+    // Append count characters from str (which may point into this string).
+    void appendRange(const char* str, size_t count) {
+        if (len + count > capacity()) {
+            std::less_equal<const char*> le;
+            bool aliased = le(data, str) && le(str, data + len);
+            size_t offset = aliased ? static_cast<size_t>(str - data) : 0;
+            grow(len + count);
+            if (aliased) str = data + offset;
+        }
+        std::memcpy(data + len, str, count);
+        len += count;
+        data[len] = '\0';
+    }
+
+    // Replace the contents with count characters from str.
+    void assign(const char* str, size_t count) {
+        if (count > capacity()) {
+            char* newData = allocate(count);
+            release();
+            data = newData;
+            heapCapacity = count;
+        }
+        std::memmove(data, str, count);
+        len = count;
+        data[len] = '\0';
+    }
+
+    // Construct from a character range (need not be null-terminated).
+    String(const char* str, size_t count, std::pmr::memory_resource* res = threadResource)
+        : data(local), len(0), resource(res) {
+        local[0] = '\0';
+        assign(str, count);
+    }
+
+    // Take other's storage (and the resource it came from), leaving it empty.
+    void steal(String& other) noexcept {
+        resource = other.resource;
+        if (other.isInline()) {
+            std::memcpy(local, other.local, other.len + 1);
+            data = local;
+        } else {
+            data = other.data;
+            heapCapacity = other.heapCapacity;
+            other.data = other.local;
+        }
+        len = other.len;
+        other.len = 0;
+        other.local[0] = '\0';
+    }
+
+    // Pieces accepted by concat(), as (pointer, length)
+    static std::pair<const char*, size_t> piece(const String& str) { return {str.data, str.len}; }
+    static std::pair<const char*, size_t> piece(const char* str) { return {str, std::strlen(str)}; }
+    static std::pair<const char*, size_t> piece(const char& c) { return {&c, 1}; }
+    static std::pair<const char*, size_t> piece(const StringView& view) { return {view.data(), view.length()}; }
+
+    // Direct access to a stream buffer's get area, so extraction can copy whole runs of
+    // buffered characters instead of going through the buffer one character at a time.
+    struct GetArea : std::streambuf {
+        static char* next(std::streambuf* buf) {
+            return (buf->*&GetArea::gptr)();
+        }
+
+        static char* end(std::streambuf* buf) {
+            return (buf->*&GetArea::egptr)();
+        }
+
+        static void advance(std::streambuf* buf, size_t n) {
+            (buf->*&GetArea::gbump)(static_cast<int>(n));
+        }
+    };
+
+public:
+    // Constructors
+    // Heap buffers come from the resource installed by ResourceScope on the constructing
+    // thread (global new[] if none), or from the resource passed explicitly.
+    String() : data(local), len(0), resource(threadResource) {
+        local[0] = '\0';
+    }
+
+    String(const char* str) : String(str, std::strlen(str)) {}
+
+    explicit String(StringView view) : String(view.data(), view.length()) {}
+
+    String(const char* str, std::pmr::memory_resource* res) : String(str, std::strlen(str), res) {}
+
+    String(StringView view, std::pmr::memory_resource* res) : String(view.data(), view.length(), res) {}
+
+    String(const String& other) : String(other.data, other.len) {}
+
+    // Move constructor
+    String(String&& other) noexcept : data(local), len(0), resource(nullptr) {
+        steal(other);
+    }
+
+    // Destructor
+    ~String() {
+        release();
+    }
+
+    // Copy assignment
+    String& operator=(const String& other) {
+        if (this != &other) {
+            assign(other.data, other.len);
+        }
+        return *this;
+    }
+
+    // Move assignment. Like std::pmr containers, the target keeps its resource: the buffer
+    // is taken over only when both came from the same resource, and copied otherwise.
+    String& operator=(String&& other) {
+        if (this == &other) return *this;
+        if (resource != other.resource) {
+            assign(other.data, other.len);
+            return *this;
+        }
+        release();
+        steal(other);
+        return *this;
+    }
+
+    // Concatenation with assignment (operator+=)
+    String& operator+=(const String& other) {
+        appendRange(other.data, other.len);
+        return *this;
+    }
+
+    String& operator+=(const char* str) {
+        appendRange(str, std::strlen(str));
+        return *this;
+    }
+
+    String& operator+=(char c) {
+        push_back(c);
+        return *this;
+    }
+
+    // Append (same as operator+=)
+    String& append(const String& other) {
+        appendRange(other.data, other.len);
+        return *this;
+    }
+
+    String& append(const char* str, size_t count) {
+        appendRange(str, count);
+        return *this;
+    }
+
+    String& append(char c) {
+        push_back(c);
+        return *this;
+    }
+
+    void push_back(char c) {
+        if (len == capacity()) grow(len + 1);
+        data[len++] = c;
+        data[len] = '\0';
+    }
+
+    // Addition (operator+); the result is sized once for both operands
+    String operator+(const String& other) const & {
+        return concat(*this, other);
+    }
+
+    String operator+(const char* str) const & {
+        return concat(*this, str);
+    }
+
+    // Addition on a temporary appends to it and reuses its buffer, so chains such as
+    // a + ", " + b + "!" copy the left-hand side only once
+    String operator+(const String& other) && {
+        appendRange(other.data, other.len);
+        return std::move(*this);
+    }
+
+    String operator+(const char* str) && {
+        appendRange(str, std::strlen(str));
+        return std::move(*this);
+    }
+
+    friend String operator+(const char* str, const String& other) {
+        return concat(str, other);
+    }
+
+    // Concatenate any number of Strings, C strings and characters with a single allocation
+    template <typename... Parts>
+    static String concat(const Parts&... parts) {
+        const std::pair<const char*, size_t> pieces[] = {piece(parts)...};
+        size_t total = 0;
+        for (const auto& p : pieces) total += p.second;
+        String result;
+        result.reserveExact(total);
+        for (const auto& p : pieces) {
+            std::memcpy(result.data + result.len, p.first, p.second);
+            result.len += p.second;
+        }
+        result.data[result.len] = '\0';
+        return result;
+    }
+
+    // Comparison operators (length-aware; lengths are compared before any bytes)
+    bool operator==(const String& other) const {
+        return len == other.len && std::memcmp(data, other.data, len) == 0;
+    }
+
+    bool operator!=(const String& other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(const String& other) const {
+        return view() < other.view();
+    }
+
+    bool operator>(const String& other) const {
+        return other.view() < view();
+    }
+
+    // Hash of the contents (see hashBytes)
+    uint64_t hash() const {
+        return hashBytes(data, len);
+    }
+
+    // Subscript operator (non-const)
+    char& operator[](size_t index) {
+        if (index >= len) {
+            throw std::out_of_range("Index out of range");
+        }
+        return data[index];
+    }
+
+    // Subscript operator (const)
+    const char& operator[](size_t index) const {
+        if (index >= len) {
+            throw std::out_of_range("Index out of range");
+        }
+        return data[index];
+    }
+
+    // Stream insertion (operator<<)
+    friend std::ostream& operator<<(std::ostream& os, const String& str) {
+        os << str.data;
+        return os;
+    }
+
+    // Stream extraction (operator>>)
+    // Reads one whitespace-delimited token of any length straight from the stream buffer
+    // into the string's own storage, honouring the stream's width() like std::string.
+    friend std::istream& operator>>(std::istream& is, String& str) {
+        std::ios_base::iostate state = std::ios_base::goodbit;
+        std::istream::sentry sentry(is); // Skips leading whitespace
+        if (sentry) {
+            str.clear();
+            std::streamsize width = is.width();
+            size_t limit = width > 0 ? static_cast<size_t>(width) : std::numeric_limits<size_t>::max();
+            const std::ctype<char>& ctype = std::use_facet<std::ctype<char>>(is.getloc());
+            std::streambuf* buf = is.rdbuf();
+            while (str.len < limit) {
+                if (buf->sgetc() == std::char_traits<char>::eof()) {
+                    state |= std::ios_base::eofbit;
+                    break;
+                }
+                const char* begin = GetArea::next(buf);
+                if (begin == GetArea::end(buf)) { // Unbuffered stream: one character at a time
+                    char c = static_cast<char>(buf->sgetc());
+                    if (ctype.is(std::ctype_base::space, c)) break;
+                    str.push_back(c);
+                    buf->sbumpc();
+                    continue;
+                }
+                const char* end = begin + std::min<size_t>(GetArea::end(buf) - begin, limit - str.len);
+                const char* stop = ctype.scan_is(std::ctype_base::space, begin, end);
+                str.appendRange(begin, stop - begin);
+                GetArea::advance(buf, stop - begin);
+                if (stop != end) break;
+            }
+            is.width(0);
+            if (str.len == 0) state |= std::ios_base::failbit;
+        }
+        if (state) is.setstate(state);
+        return is;
+    }
+
+    // Read characters up to (and consuming, but not storing) delim, like std::getline
+    friend std::istream& getline(std::istream& is, String& str, char delim = '\n') {
+        std::ios_base::iostate state = std::ios_base::goodbit;
+        std::istream::sentry sentry(is, true);
+        if (sentry) {
+            str.clear();
+            std::streambuf* buf = is.rdbuf();
+            bool extracted = false;
+            while (true) {
+                if (buf->sgetc() == std::char_traits<char>::eof()) {
+                    state |= std::ios_base::eofbit;
+                    break;
+                }
+                extracted = true;
+                const char* begin = GetArea::next(buf);
+                const char* end = GetArea::end(buf);
+                if (begin == end) { // Unbuffered stream: one character at a time
+                    char c = static_cast<char>(buf->sbumpc());
+                    if (c == delim) break;
+                    str.push_back(c);
+                    continue;
+                }
+                const char* stop = static_cast<const char*>(std::memchr(begin, delim, end - begin));
+                if (stop) {
+                    str.appendRange(begin, stop - begin);
+                    GetArea::advance(buf, stop - begin + 1);
+                    break;
+                }
+                str.appendRange(begin, end - begin);
+                GetArea::advance(buf, end - begin);
+            }
+            if (!extracted) state |= std::ios_base::failbit;
+        }
+        if (state) is.setstate(state);
+        return is;
+    }
+
+    // Read a whole file with a single allocation (from res, the current scope's by default)
+    static String readFile(const char* path, std::pmr::memory_resource* res = threadResource) {
+        std::FILE* file = std::fopen(path, "rb");
+        if (!file) throw std::runtime_error(std::string("Cannot open ") + path);
+        String result("", res);
+        char chunk[1 << 16];
+        if (std::fseek(file, 0, SEEK_END) == 0) {
+            long size = std::ftell(file);
+            if (size > 0) result.reserveExact(static_cast<size_t>(size));
+            std::rewind(file);
+        }
+        // Read into the reserved storage; keep going in case the file grew or is not seekable
+        while (true) {
+            size_t room = result.capacity() - result.len;
+            if (room == 0) {
+                size_t n = std::fread(chunk, 1, sizeof(chunk), file);
+                if (n == 0) break;
+                result.appendRange(chunk, n);
+                continue;
+            }
+            size_t n = std::fread(result.data + result.len, 1, room, file);
+            result.len += n;
+            if (n < room) break;
+        }
+        result.data[result.len] = '\0';
+        bool failed = std::ferror(file) != 0;
+        std::fclose(file);
+        if (failed) throw std::runtime_error(std::string("Error reading ") + path);
+        return result;
+    }
+
+    // Methods
+    size_t length() const {
+        return len;
+    }
+
+    // Characters that fit without reallocating (excluding the terminator)
+    size_t capacity() const {
+        return isInline() ? INLINE_CAPACITY : heapCapacity;
+    }
+
+    bool empty() const {
+        return len == 0;
+    }
+
+    // Ensure room for at least `chars` characters
+    void reserve(size_t chars) {
+        reserveExact(chars);
+    }
+
+    // Release unused capacity, moving back to inline storage when the string fits
+    void shrink_to_fit() {
+        if (isInline() || heapCapacity == len) return;
+        char* old = data;
+        size_t oldCapacity = heapCapacity;
+        if (len <= INLINE_CAPACITY) {
+            std::memcpy(local, old, len + 1);
+            data = local;
+        } else {
+            data = allocate(len);
+            std::memcpy(data, old, len + 1);
+        }
+        deallocate(old, oldCapacity);
+        if (!isInline()) heapCapacity = len;
+    }
+
+    // Clear the contents but keep the storage for reuse
+    void clear() {
+        len = 0;
+        data[0] = '\0';
+    }
+
+    const char* c_str() const {
+        return data;
+    }
+
+    // Non-owning view of the contents
+    StringView view() const {
+        return StringView(data, len);
+    }
+
+    operator StringView() const {
+        return view();
+    }
+
+    // Number of heap buffers allocated by Strings on the calling thread so far
+    static size_t heapAllocations() {
+        return allocations;
+    }
+
+    std::pmr::memory_resource* memoryResource() const {
+        return resource;
+    }
+
+    // Installs a memory resource for every String constructed on this thread while the
+    // scope is alive (including substr, case conversion and split results).
+    class ResourceScope {
+    private:
+        std::pmr::memory_resource* previous;
+
+    public:
+        explicit ResourceScope(std::pmr::memory_resource* res) : previous(threadResource) {
+            threadResource = res;
+        }
+
+        ~ResourceScope() {
+            threadResource = previous;
+        }
+
+        ResourceScope(const ResourceScope&) = delete;
+        ResourceScope& operator=(const ResourceScope&) = delete;
+    };
+
+    // Substring
+    String substr(size_t start, size_t count) const {
+        if (start >= len) throw std::out_of_range("Index out of range");
+        size_t actualCount = std::min(count, len - start);
+        return String(data + start, actualCount);
+    }
+
+    // Case conversion (ASCII, plus Latin-1, Greek and Cyrillic letters in UTF-8)
+    String toUpperCase() const {
+        String result(*this);
+        result.toUpperInPlace();
+        return result;
+    }
+
+    String toLowerCase() const {
+        String result(*this);
+        result.toLowerInPlace();
+        return result;
+    }
+
+    String& toUpperInPlace() {
+        convertCase(data, len, true);
+        return *this;
+    }
+
+    String& toLowerInPlace() {
+        convertCase(data, len, false);
+        return *this;
+    }
+
+    // True if every byte is 7-bit ASCII
+    bool isAscii() const {
+        size_t i = 0;
+#if defined(__SSE2__)
+        __m128i any = _mm_setzero_si128();
+        for (; i + 16 <= len; i += 16) {
+            any = _mm_or_si128(any, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        }
+        if (_mm_movemask_epi8(any) != 0) return false;
+#endif
+        unsigned char bits = 0;
+        for (; i < len; ++i) bits |= static_cast<unsigned char>(data[i]);
+        return bits < 0x80;
+    }
+
+    // UTF-8
+    // length() and operator[] stay byte-based; these work in code points.
+    bool isValidUtf8() const {
+        return Utf8::validate(data, len);
+    }
+
+    size_t codePointCount() const {
+        return Utf8::countCodePoints(data, len);
+    }
+
+    Utf8::CodePoints codePoints() const {
+        return Utf8::CodePoints(data, len);
+    }
+
+    // Substring of n code points starting at code point start (see Utf8Index for
+    // repeated random access on long strings)
+    String substrCodePoints(size_t start, size_t n = npos) const {
+        size_t first = 0;
+        for (size_t i = 0; i < start; ++i) {
+            if (first >= len) throw std::out_of_range("Code point index out of range");
+            first = Utf8::next(data, len, first);
+        }
+        size_t last = first;
+        for (size_t i = 0; i < n && last < len; ++i) last = Utf8::next(data, len, last);
+        return String(data + first, last - first);
+    }
+
+    std::u16string toUtf16() const {
+        requireValidUtf8();
+        std::u16string result(len, u'\0');
+        size_t out = 0;
+        const char* p = data;
+        const char* end = data + len;
+        while (p < end) {
+#if defined(__SSE2__)
+            // Widen ASCII runs 16 bytes at a time
+            while (end - p >= 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                if (_mm_movemask_epi8(block) != 0) break;
+                __m128i zero = _mm_setzero_si128();
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&result[out]), _mm_unpacklo_epi8(block, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&result[out + 8]), _mm_unpackhi_epi8(block, zero));
+                p += 16;
+                out += 16;
+            }
+            if (p == end) break;
+#endif
+            char32_t cp = Utf8::decode(p, end);
+            if (cp < 0x10000) {
+                result[out++] = static_cast<char16_t>(cp);
+            } else {
+                cp -= 0x10000;
+                result[out++] = static_cast<char16_t>(0xD800 + (cp >> 10));
+                result[out++] = static_cast<char16_t>(0xDC00 + (cp & 0x3FF));
+            }
+        }
+        result.resize(out);
+        return result;
+    }
+
+    std::u32string toUtf32() const {
+        requireValidUtf8();
+        std::u32string result(len, U'\0');
+        size_t out = 0;
+        const char* p = data;
+        const char* end = data + len;
+        while (p < end) {
+#if defined(__SSE2__)
+            while (end - p >= 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                if (_mm_movemask_epi8(block) != 0) break;
+                __m128i zero = _mm_setzero_si128();
+                __m128i low = _mm_unpacklo_epi8(block, zero), high = _mm_unpackhi_epi8(block, zero);
+                __m128i* dst = reinterpret_cast<__m128i*>(&result[out]);
+                _mm_storeu_si128(dst, _mm_unpacklo_epi16(low, zero));
+                _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(low, zero));
+                _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(high, zero));
+                _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(high, zero));
+                p += 16;
+                out += 16;
+            }
+            if (p == end) break;
+#endif
+            result[out++] = Utf8::decode(p, end);
+        }
+        result.resize(out);
+        return result;
+    }
+
+    static String fromUtf16(const std::u16string& str) {
+        String result;
+        result.reserveExact(str.size() * 3);
+        for (size_t i = 0; i < str.size(); ++i) {
+            char32_t cp = str[i];
+            if (cp >= 0xD800 && cp <= 0xDFFF) {
+                if (cp > 0xDBFF || i + 1 == str.size() || str[i + 1] < 0xDC00 || str[i + 1] > 0xDFFF) {
+                    throw std::runtime_error("Unpaired UTF-16 surrogate");
+                }
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (str[++i] - 0xDC00);
+            }
+            result.len += Utf8::encode(cp, result.data + result.len);
+        }
+        result.data[result.len] = '\0';
+        return result;
+    }
+
+    static String fromUtf32(const std::u32string& str) {
+        String result;
+        result.reserveExact(str.size() * 4);
+        for (char32_t cp : str) {
+            if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) throw std::runtime_error("Invalid code point");
+            result.len += Utf8::encode(cp, result.data + result.len);
+        }
+        result.data[result.len] = '\0';
+        return result;
+    }
+
+    // Find a substring at or after pos (npos if absent)
+    // (one-off searches; build a Searcher to look for the same needle repeatedly)
+    size_t find(const String& substr, size_t pos = 0) const {
+        return Searcher::findOnce(data, len, substr.data, substr.len, pos);
+    }
+
+    size_t find(const char* substr, size_t pos = 0) const {
+        return Searcher::findOnce(data, len, substr, std::strlen(substr), pos);
+    }
+
+    // Find the last occurrence starting at or before pos (npos if absent)
+    size_t rfind(const String& substr, size_t pos = npos) const {
+        return Searcher::rfindOnce(data, len, substr.data, substr.len, pos);
+    }
+
+    // Iterate over the positions of every occurrence (overlapping matches included)
+    Searcher::Matches findAll(const String& substr) const {
+        return Searcher::Matches(std::make_unique<Searcher>(substr.data, substr.len), data, len);
+    }
+
+    // Split into a vector of substrings (a trailing empty piece is dropped)
+    std::vector<String> split(const char delimiter) const {
+        std::vector<String> result;
+        for (StringView piece : splitView(delimiter)) {
+            result.push_back(String(piece.data(), piece.length()));
+        }
+        if (!result.empty() && result.back().empty()) result.pop_back();
+        return result;
+    }
+
+    // Lazy splits yielding views into this string (no copies, no allocation)
+    SplitRange splitView(char delimiter) const {
+        return SplitRange(view(), delimiter);
+    }
+
+    SplitRange splitView(StringView delimiter) const {
+        return SplitRange(view(), delimiter, SplitRange::Mode::Sequence);
+    }
+
+    // Split at any of the characters in delimiters
+    SplitRange splitAny(StringView delimiters) const {
+        return SplitRange(view(), delimiters, SplitRange::Mode::AnyOf);
+    }
+
+    // Join a vector of strings with a delimiter
+    static String join(const std::vector<String>& parts, const char* delimiter) {
+        String result;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            result += parts[i];
+            if (i != parts.size() - 1) {
+                result += delimiter;
+            }
+        }
+        return result;
+    }
+
+    // Trim whitespace, returning a view into this string
+    StringView trim() const & {
+        size_t start = 0;
+        while (start < len && isSpace(data[start])) ++start;
+
+        size_t end = len;
+        while (end > start && isSpace(data[end - 1])) --end;
+
+        return StringView(data + start, end - start);
+    }
+
+    // Trimming a temporary yields a String, since a view would dangle
+    String trim() && {
+        trimInPlace();
+        return std::move(*this);
+    }
+
+    String& trimInPlace() {
+        StringView trimmed = static_cast<const String&>(*this).trim();
+        std::memmove(data, trimmed.data(), trimmed.length());
+        len = trimmed.length();
+        data[len] = '\0';
+        return *this;
+    }
+};
+
+// Compiled multi-pattern matcher (Aho-Corasick). All patterns are found in one pass over
+// the text by a deterministic automaton stored as one flat transition table indexed by
+// state row and byte class (only bytes occurring in some pattern get their own class).
+// When the patterns begin with only a few distinct bytes, the scan skips ahead through
+// text that cannot start a match 16 bytes at a time (SSE2) while in the root state.
+class MultiSearcher {
+public:
+    struct Match {
+        size_t pattern;  // Index of the pattern in construction order
+        size_t position; // Byte offset where the match starts
+    };
+
 private:
-    char* data;      // Dynamic character array to store the string.
-    size_t len;      // Length of the string.
-    size_t capacity; // Capacity for optimization (to minimize reallocations).
+    static constexpr size_t MAX_PREFILTER_BYTES = 4;
 
-    // Helper function to reallocate memory for the string.
-    void resize(size_t newCapacity) {
-        char* newData = new char[newCapacity];
-        std::strncpy(newData, data, len);
-        delete[] data;
-        data = newData;
-        capacity = newCapacity;
+    uint8_t classOf[256];
+    uint32_t classes = 1;              // Class 0 is every byte that occurs in no pattern
+    std::vector<uint32_t> table;       // Entry: target row offset (state * classes)
+    uint32_t outputRow = 0;            // Rows from here on belong to states with matches
+    std::vector<uint32_t> outputStart; // Per matching state: range of `outputs`
+    std::vector<uint32_t> outputs;     // Patterns ending at each state, longest first
+    std::vector<size_t> lengths;
+    std::vector<unsigned char> startBytes; // Distinct first bytes, if few enough to prefilter
+    alignas(16) unsigned char startSplats[MAX_PREFILTER_BYTES][16]; // Each start byte repeated 16 times
+
+    void build(const std::vector<StringView>& patterns) {
+        std::memset(classOf, 0, sizeof(classOf));
+        bool seen[256] = {};
+        for (const StringView& pattern : patterns) {
+            if (pattern.empty()) throw std::invalid_argument("Empty pattern");
+            for (size_t i = 0; i < pattern.length(); ++i) {
+                unsigned char c = static_cast<unsigned char>(pattern[i]);
+                if (!classOf[c]) classOf[c] = static_cast<uint8_t>(classes++);
+                if (i == 0) seen[c] = true;
+            }
+            lengths.push_back(pattern.length());
+        }
+        for (int c = 0; c < 256; ++c) {
+            if (seen[c]) startBytes.push_back(static_cast<unsigned char>(c));
+        }
+        if (startBytes.size() > MAX_PREFILTER_BYTES) startBytes.clear();
+        for (size_t k = 0; k < startBytes.size(); ++k) std::memset(startSplats[k], startBytes[k], 16);
+
+        // Trie
+        const uint32_t NONE = std::numeric_limits<uint32_t>::max();
+        std::vector<std::vector<uint32_t>> stateOutputs(1);
+        table.assign(classes, NONE);
+        for (size_t p = 0; p < patterns.size(); ++p) {
+            uint32_t state = 0;
+            for (size_t i = 0; i < patterns[p].length(); ++i) {
+                uint32_t& next = table[state * classes + classOf[static_cast<unsigned char>(patterns[p][i])]];
+                if (next == NONE) {
+                    next = static_cast<uint32_t>(stateOutputs.size());
+                    stateOutputs.emplace_back();
+                    table.resize(table.size() + classes, NONE);
+                }
+                state = table[state * classes + classOf[static_cast<unsigned char>(patterns[p][i])]];
+            }
+            stateOutputs[state].push_back(static_cast<uint32_t>(p));
+        }
+        if (stateOutputs.size() * classes > std::numeric_limits<uint32_t>::max()) throw std::length_error("Too many patterns");
+
+        // Failure links in breadth-first order, folded into a complete transition table
+        std::vector<uint32_t> fail(stateOutputs.size(), 0);
+        std::vector<uint32_t> queue;
+        queue.reserve(stateOutputs.size());
+        for (uint32_t c = 0; c < classes; ++c) {
+            uint32_t& next = table[c];
+            if (next == NONE) next = 0;
+            else queue.push_back(next);
+        }
+        for (size_t head = 0; head < queue.size(); ++head) {
+            uint32_t state = queue[head];
+            const std::vector<uint32_t>& inherited = stateOutputs[fail[state]];
+            stateOutputs[state].insert(stateOutputs[state].end(), inherited.begin(), inherited.end());
+            for (uint32_t c = 0; c < classes; ++c) {
+                uint32_t& next = table[state * classes + c];
+                uint32_t fallback = table[fail[state] * classes + c];
+                if (next == NONE) {
+                    next = fallback;
+                } else {
+                    fail[next] = fallback;
+                    queue.push_back(next);
+                }
+            }
+        }
+
+        // Renumber so that every state with matches comes after every state without: the
+        // scan then detects matches with one comparison and no masking. Entries are stored
+        // premultiplied by the row length.
+        const uint32_t states = static_cast<uint32_t>(stateOutputs.size());
+        std::vector<uint32_t> order, renamed(states);
+        order.reserve(states);
+        for (uint32_t state = 0; state < states; ++state) {
+            if (stateOutputs[state].empty()) order.push_back(state);
+        }
+        outputRow = static_cast<uint32_t>(order.size()) * classes;
+        for (uint32_t state = 0; state < states; ++state) {
+            if (!stateOutputs[state].empty()) order.push_back(state);
+        }
+        for (uint32_t id = 0; id < states; ++id) renamed[order[id]] = id;
+        std::vector<uint32_t> flat(table.size());
+        for (uint32_t id = 0; id < states; ++id) {
+            for (uint32_t c = 0; c < classes; ++c) flat[id * classes + c] = renamed[table[order[id] * classes + c]] * classes;
+        }
+        table.swap(flat);
+        outputStart.reserve(states - outputRow / classes + 1);
+        for (uint32_t id = outputRow / classes; id < states; ++id) {
+            const std::vector<uint32_t>& list = stateOutputs[order[id]];
+            outputStart.push_back(static_cast<uint32_t>(outputs.size()));
+            outputs.insert(outputs.end(), list.begin(), list.end());
+        }
+        outputStart.push_back(static_cast<uint32_t>(outputs.size()));
     }
 
-public:
-    // Constructors
-    String() : data(new char[1]{'\0'}), len(0), capacity(1) {}
+    // First position at or after i whose byte can start a pattern (n if none)
+    size_t nextCandidate(const char* text, size_t n, size_t i) const {
+#if defined(__SSE2__)
+        const __m128i* needles = reinterpret_cast<const __m128i*>(startSplats);
+        for (; i + 16 <= n; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            __m128i hits = _mm_cmpeq_epi8(block, needles[0]);
+            for (size_t k = 1; k < startBytes.size(); ++k) hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, needles[k]));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            if (mask) return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+#endif
+        for (; i < n; ++i) {
+            if (std::memchr(startBytes.data(), text[i], startBytes.size())) return i;
+        }
+        return n;
+    }
 
-    String(const char* str) : len(std::strlen(str)), capacity(len + 1) {
-        data = new char[capacity];
-        std::strcpy(data, str);
+    template<typename Callback>
+    bool report(uint32_t state, size_t end, Callback& onMatch) const {
+        for (uint32_t k = outputStart[state]; k < outputStart[state + 1]; ++k) {
+            size_t pattern = outputs[k];
+            if (!onMatch(pattern, end + 1 - lengths[pattern])) return false;
+        }
+        return true;
     }
 
-    String(const String& other) : len(other.len), capacity(other.capacity) {
-        data = new char[capacity];
-        std::strcpy(data, other.data);
+public:
+    // Build from any range of patterns convertible to StringView (String, const char*, ...)
+    template<typename Range>
+    explicit MultiSearcher(const Range& patterns) {
+        std::vector<StringView> views;
+        for (const auto& pattern : patterns) views.push_back(StringView(pattern));
+        build(views);
     }
 
-    // Destructor
-    ~String() {
-        delete[] data;
+    MultiSearcher(std::initializer_list<StringView> patterns) {
+        build(std::vector<StringView>(patterns));
     }
 
-    // Copy assignment
-    String& operator=(const String& other) {
-        if (this != &other) {
-            delete[] data;
-            len = other.len;
-            capacity = other.capacity;
-            data = new char[capacity];
-            std::strcpy(data, other.data);
+    size_t patternCount() const {
+        return lengths.size();
+    }
+
+    // Call onMatch(pattern, position) for every occurrence of every pattern, in order of
+    // match end (longest first among matches ending at the same byte). Return false from
+    // onMatch to stop the scan.
+    template<typename Callback>
+    void scan(const char* text, size_t n, Callback&& onMatch) const {
+        const uint32_t* transitions = table.data();
+        const uint8_t* byteClass = classOf;
+        const uint32_t firstOutput = outputRow;
+        uint32_t row = 0;
+        if (startBytes.empty()) {
+            for (size_t i = 0; i < n; ++i) {
+                row = transitions[row + byteClass[static_cast<unsigned char>(text[i])]];
+                if (row >= firstOutput && !report((row - firstOutput) / classes, i, onMatch)) return;
+            }
+            return;
+        }
+        size_t i = 0;
+        while (i < n) {
+            if (row == 0) {
+                i = nextCandidate(text, n, i);
+                if (i == n) break;
+            }
+            // Run the automaton until the next match or back to the root
+            do {
+                row = transitions[row + byteClass[static_cast<unsigned char>(text[i++])]];
+            } while (row < firstOutput && row != 0 && i < n);
+            if (row >= firstOutput && !report((row - firstOutput) / classes, i - 1, onMatch)) return;
         }
-        return *this;
     }
 
-    // Concatenation with assignment (operator+=)
-    String& operator+=(const String& other) {
-        if (len + other.len + 1 > capacity) {
-            resize(len + other.len + 1);
+    std::vector<Match> findAll(StringView text) const {
+        std::vector<Match> matches;
+        scan(text.data(), text.length(), [&](size_t pattern, size_t position) {
+            matches.push_back(Match{pattern, position});
+            return true;
+        });
+        return matches;
+    }
+
+    size_t count(StringView text) const {
+        size_t total = 0;
+        scan(text.data(), text.length(), [&](size_t, size_t) {
+            ++total;
+            return true;
+        });
+        return total;
+    }
+
+    bool containsAny(StringView text) const {
+        bool found = false;
+        scan(text.data(), text.length(), [&](size_t, size_t) {
+            found = true;
+            return false;
+        });
+        return found;
+    }
+};
+
+// Read-only view of a whole file, memory-mapped where the platform supports it (otherwise
+// read into a String). view() can be split and searched without copying the file.
+class MappedFile {
+private:
+    const char* ptr = nullptr;
+    size_t size = 0;
+    String fallback;
+
+public:
+    explicit MappedFile(const char* path) {
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) throw std::runtime_error(std::string("Cannot open ") + path);
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error(std::string("Cannot stat ") + path);
         }
-        std::strcat(data, other.data);
-        len += other.len;
-        return *this;
+        size = static_cast<size_t>(info.st_size);
+        if (size > 0) {
+            void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (mapped == MAP_FAILED) throw std::runtime_error(std::string("Cannot map ") + path);
+            ::madvise(mapped, size, MADV_SEQUENTIAL);
+            ptr = static_cast<const char*>(mapped);
+            return;
+        }
+        ::close(fd);
+#endif
+        fallback = String::readFile(path, nullptr);  // Outlives any ResourceScope
+        ptr = fallback.c_str();
+        size = fallback.length();
     }
 
-    // Addition (operator+)
-    String operator+(const String& other) const {
-        String result(*this);
-        result += other;
-        return result;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (ptr && ptr != fallback.c_str()) ::munmap(const_cast<char*>(ptr), size);
+#endif
     }
 
-    // Comparison operators
-    bool operator==(const String& other) const {
-        return std::strcmp(data, other.data) == 0;
+    StringView view() const {
+        return StringView(ptr, size);
     }
 
-    bool operator!=(const String& other) const {
-        return !(*this == other);
+    size_t length() const {
+        return size;
     }
+};
 
-    bool operator<(const String& other) const {
-        return std::strcmp(data, other.data) < 0;
+// Bump-pointer arena for request-scoped Strings. Allocation advances a cursor through
+// large blocks; deallocation only rolls the cursor back when the freed buffer is the most
+// recent one (so a growing string reuses its space), and release() frees everything in one
+// shot. Not thread-safe: use one arena per thread or per request, and destroy the Strings
+// that use it before calling release().
+class StringArena : public std::pmr::memory_resource {
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+    };
+
+    Block* blocks = nullptr; // Most recent block first
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t blockSize;
+    size_t used = 0;
+
+    void addBlock(size_t minimum) {
+        size_t size = std::max(blockSize, minimum + sizeof(Block));
+        char* raw = static_cast<char*>(::operator new(size));
+        blocks = new (raw) Block{blocks, size};
+        cursor = raw + sizeof(Block);
+        limit = raw + size;
     }
 
-    bool operator>(const String& other) const {
-        return std::strcmp(data, other.data) > 0;
+    static char* alignUp(char* p, size_t alignment) {
+        uintptr_t value = reinterpret_cast<uintptr_t>(p);
+        return p + ((alignment - value % alignment) % alignment);
     }
 
-    // Subscript operator (non-const)
-    char& operator[](size_t index) {
-        if (index >= len) {
-            throw std::out_of_range("Index out of range");
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        char* p = cursor ? alignUp(cursor, alignment) : nullptr;
+        // Aligning may step past the end of a block whose size is not a multiple of alignment
+        if (!p || p > limit || bytes > static_cast<size_t>(limit - p)) {
+            // Room for the worst-case padding, so the aligned request always fits
+            addBlock(bytes + alignment - 1);
+            p = alignUp(cursor, alignment);
         }
-        return data[index];
+        cursor = p + bytes;
+        used += bytes;
+        return p;
     }
 
-    // Subscript operator (const)
-    const char& operator[](size_t index) const {
-        if (index >= len) {
-            throw std::out_of_range("Index out of range");
+    void do_deallocate(void* p, size_t bytes, size_t) override {
+        if (static_cast<char*>(p) + bytes == cursor) {
+            cursor = static_cast<char*>(p);
+            used -= bytes;
         }
-        return data[index];
     }
 
-    // Stream insertion (operator<<)
-    friend std::ostream& operator<<(std::ostream& os, const String& str) {
-        os << str.data;
-        return os;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
     }
 
-    // Stream extraction (operator>>)
-    friend std::istream& operator>>(std::istream& is, String& str) {
-        char buffer[1000]; // Temp buffer (adjust as necessary).
-        is >> buffer;
-        str = String(buffer);
-        return is;
+public:
+    explicit StringArena(size_t blockBytes = 64 * 1024) : blockSize(blockBytes) {}
+
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    ~StringArena() {
+        while (blocks) {
+            Block* next = blocks->next;
+            ::operator delete(blocks);
+            blocks = next;
+        }
     }
 
-    // Methods
-    size_t length() const {
-        return len;
+    // Free all allocations at once, keeping the newest block for the next request
+    void release() {
+        if (!blocks) return;
+        while (blocks->next) {
+            Block* next = blocks->next->next;
+            ::operator delete(blocks->next);
+            blocks->next = next;
+        }
+        cursor = reinterpret_cast<char*>(blocks) + sizeof(Block);
+        limit = reinterpret_cast<char*>(blocks) + blocks->size;
+        used = 0;
     }
 
-    bool empty() const {
-        return len == 0;
+    size_t bytesUsed() const {
+        return used;
     }
+};
 
-    void clear() {
-        delete[] data;
-        data = new char[1]{'\0'};
-        len = 0;
-        capacity = 1;
+// Rope: a string stored as a balanced tree of chunks, for large text that is edited in the
+// middle. The tree is a persistent treap keyed by position: nodes are immutable and shared,
+// so insert, erase, substr and concatenation each build only O(log n) new nodes and never
+// copy the text itself. Chunks are slices of shared String buffers.
+class Rope {
+private:
+    static constexpr size_t CHUNK = 2048; // Target chunk size when building from flat text
+
+    struct Node;
+    using Ptr = std::shared_ptr<const Node>;
+
+    struct Node {
+        Ptr left, right;
+        std::shared_ptr<const String> buffer; // Storage shared by many chunks
+        size_t offset;                        // Start of this node's chunk within buffer
+        size_t count;                         // Length of this node's chunk
+        size_t total;                         // Length of the whole subtree
+        uint32_t priority;                    // Heap order of the treap
+
+        Node(Ptr l, std::shared_ptr<const String> buf, size_t off, size_t n, Ptr r, uint32_t pri)
+            : left(std::move(l)), right(std::move(r)), buffer(std::move(buf)), offset(off), count(n),
+              total(n + size(left) + size(right)), priority(pri) {}
+
+        const char* chunk() const { return buffer->c_str() + offset; }
+    };
+
+    Ptr root;
+
+    explicit Rope(Ptr node) : root(std::move(node)) {}
+
+    static size_t size(const Ptr& node) {
+        return node ? node->total : 0;
     }
 
-    const char* c_str() const {
-        return data;
+    static uint32_t randomPriority() {
+        thread_local uint32_t state = 2463534242u;
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
     }
 
-    // Substring
-    String substr(size_t start, size_t count) const {
-        if (start >= len) throw std::out_of_range("Index out of range");
-        size_t actualCount = std::min(count, len - start);
-        char* sub = new char[actualCount + 1];
-        std::strncpy(sub, data + start, actualCount);
-        sub[actualCount] = '\0';
-        String result(sub);
-        delete[] sub;
-        return result;
+    static Ptr make(Ptr left, const Node& chunkOf, size_t offset, size_t count, Ptr right) {
+        return std::make_shared<const Node>(std::move(left), chunkOf.buffer, offset, count, std::move(right), chunkOf.priority);
     }
 
-    // Case conversion
-    String toUpperCase() const {
-        String result(*this);
-        for (size_t i = 0; i < len; ++i) {
-            result.data[i] = std::toupper(result.data[i]);
+    // Split into [0, pos) and [pos, total)
+    static std::pair<Ptr, Ptr> split(const Ptr& node, size_t pos) {
+        if (!node) return {nullptr, nullptr};
+        size_t leftLength = size(node->left);
+        if (pos <= leftLength) {
+            auto [a, b] = split(node->left, pos);
+            return {a, make(b, *node, node->offset, node->count, node->right)};
         }
-        return result;
+        size_t middle = leftLength + node->count;
+        if (pos >= middle) {
+            auto [a, b] = split(node->right, pos - middle);
+            return {make(node->left, *node, node->offset, node->count, a), b};
+        }
+        size_t k = pos - leftLength; // Split inside this node's chunk
+        return {make(node->left, *node, node->offset, k, nullptr),
+                make(nullptr, *node, node->offset + k, node->count - k, node->right)};
     }
 
-    String toLowerCase() const {
-        String result(*this);
-        for (size_t i = 0; i < len; ++i) {
-            result.data[i] = std::tolower(result.data[i]);
+    // Concatenate two trees
+    static Ptr merge(const Ptr& a, const Ptr& b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (a->priority > b->priority) {
+            return make(a->left, *a, a->offset, a->count, merge(a->right, b));
         }
-        return result;
+        return make(merge(a, b->left), *b, b->offset, b->count, b->right);
     }
 
-    // Find a substring
-    size_t find(const String& substr) const {
-        const char* pos = std::strstr(data, substr.data);
-        if (pos) {
-            return pos - data;
+    // Build a treap over chunks of a flat buffer in O(n) (Cartesian tree construction)
+    static Ptr build(std::shared_ptr<const String> buffer) {
+        size_t n = buffer->length();
+        if (n == 0) return nullptr;
+        struct Draft {
+            size_t left = SIZE_MAX, right = SIZE_MAX, offset, count;
+            uint32_t priority;
+        };
+        std::vector<Draft> drafts;
+        for (size_t off = 0; off < n; off += CHUNK) {
+            drafts.push_back({SIZE_MAX, SIZE_MAX, off, std::min(CHUNK, n - off), randomPriority()});
+        }
+        std::vector<size_t> stack;
+        for (size_t i = 0; i < drafts.size(); ++i) {
+            size_t last = SIZE_MAX;
+            while (!stack.empty() && drafts[stack.back()].priority < drafts[i].priority) {
+                last = stack.back();
+                stack.pop_back();
+            }
+            drafts[i].left = last;
+            if (!stack.empty()) drafts[stack.back()].right = i;
+            stack.push_back(i);
         }
-        return std::string::npos;
+        std::function<Ptr(size_t)> create = [&](size_t i) -> Ptr {
+            if (i == SIZE_MAX) return nullptr;
+            const Draft& d = drafts[i];
+            return std::make_shared<const Node>(create(d.left), buffer, d.offset, d.count, create(d.right), d.priority);
+        };
+        return create(stack.front());
     }
 
-    // Split into a vector of substrings
-    std::vector<String> split(const char delimiter) const {
-        std::vector<String> result;
-        std::stringstream ss(data);
-        std::string item;
-        while (std::getline(ss, item, delimiter)) {
-            result.push_back(String(item.c_str()));
+    template <typename F>
+    static void visit(const Ptr& node, F& f) {
+        if (!node) return;
+        visit(node->left, f);
+        f(StringView(node->chunk(), node->count));
+        visit(node->right, f);
+    }
+
+public:
+    // Constructors
+    Rope() = default;
+    // Chunks are shared between ropes, so they never come from a scoped resource
+    Rope(StringView text) : root(build(std::make_shared<const String>(text, nullptr))) {}
+    Rope(const char* text) : Rope(StringView(text)) {}
+    Rope(const String& text) : Rope(text.view()) {}
+
+    size_t length() const {
+        return size(root);
+    }
+
+    bool empty() const {
+        return !root;
+    }
+
+    // Character at index, O(log n)
+    char operator[](size_t index) const {
+        if (index >= length()) throw std::out_of_range("Index out of range");
+        const Node* node = root.get();
+        for (;;) {
+            size_t leftLength = size(node->left);
+            if (index < leftLength) {
+                node = node->left.get();
+            } else if (index < leftLength + node->count) {
+                return node->chunk()[index - leftLength];
+            } else {
+                index -= leftLength + node->count;
+                node = node->right.get();
+            }
         }
-        return result;
     }
 
-    // Join a vector of strings with a delimiter
-    static String join(const std::vector<String>& parts, const char* delimiter) {
+    // Insert text before position pos
+    Rope& insert(size_t pos, StringView text) {
+        if (pos > length()) throw std::out_of_range("Index out of range");
+        auto [left, right] = split(root, pos);
+        root = merge(merge(left, build(std::make_shared<const String>(text, nullptr))), right);
+        return *this;
+    }
+
+    // Remove up to count characters starting at pos
+    Rope& erase(size_t pos, size_t count) {
+        if (pos > length()) throw std::out_of_range("Index out of range");
+        auto [left, rest] = split(root, pos);
+        root = merge(left, split(rest, count).second);
+        return *this;
+    }
+
+    // Sub-rope sharing this rope's chunks, O(log n)
+    Rope substr(size_t pos, size_t count) const {
+        if (pos > length()) throw std::out_of_range("Index out of range");
+        return Rope(split(split(root, pos).second, count).first);
+    }
+
+    // Concatenation, O(log n); both operands are left unchanged
+    Rope operator+(const Rope& other) const {
+        return Rope(merge(root, other.root));
+    }
+
+    Rope& operator+=(const Rope& other) {
+        root = merge(root, other.root);
+        return *this;
+    }
+
+    // Call f(StringView) for each chunk in order
+    template <typename F>
+    void forEachChunk(F f) const {
+        visit(root, f);
+    }
+
+    // Flatten into a String with a single allocation
+    String toString() const {
         String result;
-        for (size_t i = 0; i < parts.size(); ++i) {
-            result += parts[i];
-            if (i != parts.size() - 1) {
-                result += delimiter;
+        result.reserve(length());
+        forEachChunk([&](StringView chunk) { result.append(chunk.data(), chunk.length()); });
+        return result;
+    }
+
+    // Forward iterator over characters; keeps the path to the current chunk
+    class const_iterator {
+    private:
+        std::vector<const Node*> path; // Ancestors whose chunk and right subtree are still pending
+        const Node* current = nullptr;
+        size_t index = 0;
+
+        void descendLeft(const Node* node) {
+            while (node) {
+                path.push_back(node);
+                node = node->left.get();
             }
         }
-        return result;
+
+        void nextChunk() {
+            current = nullptr;
+            index = 0;
+            if (path.empty()) return;
+            current = path.back();
+            path.pop_back();
+            descendLeft(current->right.get());
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char*;
+        using reference = const char&;
+
+        const_iterator() = default;
+        explicit const_iterator(const Node* root) {
+            descendLeft(root);
+            nextChunk();
+        }
+
+        const char& operator*() const { return current->chunk()[index]; }
+
+        const_iterator& operator++() {
+            if (++index == current->count) nextChunk();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const { return current == other.current && index == other.index; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+    };
+
+    const_iterator begin() const { return const_iterator(root.get()); }
+    const_iterator end() const { return const_iterator(); }
+
+    friend std::ostream& operator<<(std::ostream& os, const Rope& rope) {
+        rope.forEachChunk([&](StringView chunk) { os << chunk; });
+        return os;
     }
+};
 
-    // Trim whitespace
-    String trim() const {
-        size_t start = 0;
-        while (start < len && std::isspace(data[start])) ++start;
-        
-        size_t end = len;
-        while (end > start && std::isspace(data[end - 1])) --end;
-        
-        return this->substr(start, end - start);
+// Thread-safe interning table. Each distinct text is stored once; intern() returns a
+// Symbol handle to the canonical copy, so symbols compare by pointer and carry a
+// precomputed hash. The table is split into shards, each behind its own reader-writer
+// lock, so lookups of existing symbols from many threads proceed in parallel.
+class StringPool {
+private:
+    struct Entry {
+        String text;
+        uint64_t hash;
+    };
+
+public:
+    // Handle to an interned string; copying and comparing it are O(1)
+    class Symbol {
+    private:
+        const Entry* entry = nullptr;
+
+        friend class StringPool;
+        explicit Symbol(const Entry* e) : entry(e) {}
+
+    public:
+        Symbol() = default; // The null symbol
+
+        const String& str() const {
+            static const String empty;
+            return entry ? entry->text : empty;
+        }
+
+        StringView view() const { return str().view(); }
+        size_t length() const { return str().length(); }
+        uint64_t hash() const { return entry ? entry->hash : 0; }
+
+        bool operator==(Symbol other) const { return entry == other.entry; }
+        bool operator!=(Symbol other) const { return entry != other.entry; }
+        // Arbitrary but consistent order, for use as a key in ordered containers
+        bool operator<(Symbol other) const { return std::less<const Entry*>()(entry, other.entry); }
+
+        friend std::ostream& operator<<(std::ostream& os, Symbol symbol) {
+            return os << symbol.str();
+        }
+    };
+
+private:
+    struct Key {
+        StringView view;
+        uint64_t hash;
+        bool operator==(const Key& other) const { return hash == other.hash && view == other.view; }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return static_cast<size_t>(key.hash); }
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, const Entry*, KeyHash> index;
+        std::deque<Entry> entries; // Stable addresses for the canonical copies
+    };
+
+    static constexpr size_t SHARDS = 16;
+    Shard shards[SHARDS];
+
+public:
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    // Process-wide pool
+    static StringPool& global() {
+        static StringPool pool;
+        return pool;
+    }
+
+    Symbol intern(StringView text) {
+        uint64_t h = hashBytes(text.data(), text.length());
+        Shard& shard = shards[h >> 60];
+        Key key{text, h};
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.index.find(key);
+            if (it != shard.index.end()) return Symbol(it->second);
+        }
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) return Symbol(it->second);
+        shard.entries.push_back(Entry{String(text, nullptr), h});  // Lives as long as the pool, so never scoped
+        const Entry* entry = &shard.entries.back();
+        shard.index.emplace(Key{entry->text.view(), h}, entry);
+        return Symbol(entry);
     }
+
+    // Look up without inserting; returns the null symbol if text was never interned
+    Symbol find(StringView text) const {
+        uint64_t h = hashBytes(text.data(), text.length());
+        const Shard& shard = shards[h >> 60];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.index.find(Key{text, h});
+        return it != shard.index.end() ? Symbol(it->second) : Symbol();
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const Shard& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            total += shard.entries.size();
+        }
+        return total;
+    }
+};
+
+namespace std {
+template <>
+struct hash<String> {
+    size_t operator()(const String& str) const { return static_cast<size_t>(str.hash()); }
+};
+
+template <>
+struct hash<StringView> {
+    size_t operator()(StringView view) const { return static_cast<size_t>(hashBytes(view.data(), view.length())); }
+};
+
+template <>
+struct hash<StringPool::Symbol> {
+    size_t operator()(StringPool::Symbol symbol) const { return static_cast<size_t>(symbol.hash()); }
 };
+}
 
 // Example usage:
 int main() {
     String s1("Hello");
     String s2("World");
-    
+
     String s3 = s1 + ", " + s2 + "!";
     std::cout << s3 << std::endl;
 
@@ -223,5 +2406,387 @@ int main() {
     std::cout << "Upper case: " << s3.toUpperCase() << std::endl;
     std::cout << "Trimmed string: '" << s3.trim() << "'" << std::endl;
 
+    // One allocation for the whole result, however many pieces
+    String greeting = String::concat(s1, ", ", s2, '!', " Welcome back, ", s1, '.');
+    std::cout << "Concatenated: " << greeting << std::endl;
+
+    // Construction of typical key-sized strings stays on the stack
+    const char* keys[] = {"user_id", "session-token", "content-type", "x-request-id-0001", "a-key-longer-than-the-inline-buffer"};
+    const size_t rounds = 1000000;
+    size_t before = String::heapAllocations();
+    size_t totalLength = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rounds; ++i) {
+        String key(keys[i % 4]);
+        totalLength += key.length();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Constructed " << rounds << " short strings: " << rounds / seconds / 1e6 << " M/s, "
+              << String::heapAllocations() - before << " heap allocations (checksum " << totalLength << ")" << std::endl;
+
+    before = String::heapAllocations();
+    String longKey(keys[4]);
+    std::cout << "A " << longKey.length() << "-character string needs " << String::heapAllocations() - before
+              << " heap allocation" << std::endl;
+
+    // Building a long record by repeated appends: capacity doubles, so the number of
+    // reallocations grows only logarithmically with the length
+    before = String::heapAllocations();
+    String logLine;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000000; ++i) {
+        logLine += "field=";
+        logLine.push_back(static_cast<char>('0' + i % 10));
+        logLine += ' ';
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Appended " << logLine.length() / 1e6 << " MB in " << seconds * 1e3 << " ms with "
+              << String::heapAllocations() - before << " heap allocations" << std::endl;
+    logLine.clear();
+    logLine.shrink_to_fit();
+    std::cout << "After clear and shrink_to_fit, capacity: " << logLine.capacity() << std::endl;
+
+    // Substring search: positions, reverse search, all matches
+    String text("the cat sat on the mat with the hat");
+    std::cout << "find(\"the\"): " << text.find("the") << ", find(\"the\", 1): " << text.find("the", 1)
+              << ", rfind(\"the\"): " << text.rfind("the") << std::endl;
+    std::cout << "All matches of \"at\":";
+    for (size_t pos : text.findAll("at")) std::cout << " " << pos;
+    std::cout << std::endl;
+
+    // Lazy splitting into views
+    String record("id=7;; name=Ada , lang=C++;");
+    std::cout << "Split on ';':";
+    for (StringView field : record.splitView(';')) std::cout << " [" << field << "]";
+    std::cout << std::endl << "Split on \";;\":";
+    for (StringView field : record.splitView(";;")) std::cout << " [" << field << "]";
+    std::cout << std::endl << "Split on any of \";,= \":";
+    for (StringView field : record.splitAny(";,= ")) std::cout << " [" << field << "]";
+    std::cout << std::endl;
+
+    // Tokenizing a 4 MB CSV-like buffer
+    String csv;
+    csv.reserve(4 << 20);
+    while (csv.length() < (4 << 20)) csv += "12345,hello,3.14159,world,42\n";
+    auto splitStart = std::chrono::steady_clock::now();
+    size_t fields = 0, fieldBytes = 0;
+    for (StringView field : csv.splitAny(",\n")) {
+        ++fields;
+        fieldBytes += field.length();
+    }
+    double splitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - splitStart).count();
+    std::cout << "Tokenized " << fields << " fields (" << fieldBytes << " bytes) at "
+              << csv.length() / splitSeconds / 1e9 << " GB/s" << std::endl;
+    splitStart = std::chrono::steady_clock::now();
+    size_t lines = 0;
+    for (StringView line : csv.splitView('\n')) lines += !line.empty();
+    splitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - splitStart).count();
+    std::cout << "Split " << lines << " lines at " << csv.length() / splitSeconds / 1e9 << " GB/s" << std::endl;
+
+    // Case conversion and trimming, including non-ASCII letters
+    String mixed("  Grüße, Ελλάδα, Москва!\t");
+    std::cout << "Upper: '" << mixed.toUpperCase().trim() << "', lower: '" << mixed.toLowerCase().trim()
+              << "', ASCII only: " << std::boolalpha << mixed.isAscii() << std::endl;
+
+    // Per-byte throughput of in-place conversion against a std::toupper loop
+    auto caseStart = std::chrono::steady_clock::now();
+    csv.toUpperInPlace();
+    double caseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - caseStart).count();
+    caseStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < csv.length(); ++i) csv[i] = static_cast<char>(std::tolower(csv[i]));
+    double localeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - caseStart).count();
+    caseStart = std::chrono::steady_clock::now();
+    bool ascii = csv.isAscii();
+    double classifySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - caseStart).count();
+    std::cout << "toUpperInPlace: " << csv.length() / caseSeconds / 1e9 << " GB/s, std::tolower loop: "
+              << csv.length() / localeSeconds / 1e9 << " GB/s, isAscii (" << ascii << "): "
+              << csv.length() / classifySeconds / 1e9 << " GB/s" << std::endl;
+
+    // Rope: cheap edits in the middle of large text
+    Rope rope("The quick fox jumps over the dog");
+    rope.insert(10, "brown ").insert(35, "lazy ");
+    rope.erase(0, 4);
+    std::cout << "Rope: '" << rope << "', substr(6, 9): '" << rope.substr(6, 9) << "'" << std::endl;
+
+    const size_t documentSize = 4 << 20;
+    String documentText;
+    documentText.reserve(documentSize);
+    while (documentText.length() < documentSize) documentText += "All work and no play makes Jack a dull boy. ";
+    Rope document(documentText);
+    const int edits = 10000;
+    auto ropeStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < edits; ++i) {
+        size_t pos = (static_cast<size_t>(i) * 7919 * 104729) % document.length();
+        if (i % 2 == 0) document.insert(pos, "EDIT");
+        else document.erase(pos, 4);
+    }
+    double ropeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - ropeStart).count();
+    auto flatStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < 4; ++i) {
+        size_t pos = documentText.length() / 2;
+        documentText = String::concat(documentText.view().substr(0, pos), "EDIT", documentText.view().substr(pos));
+    }
+    double flatSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - flatStart).count();
+    std::cout << "Edit in 4 MB: Rope " << ropeSeconds / edits * 1e6 << " us, flat String "
+              << flatSeconds / 4 * 1e6 << " us; flattening the rope back: ";
+    flatStart = std::chrono::steady_clock::now();
+    String flattened = document.toString();
+    std::cout << std::chrono::duration<double>(std::chrono::steady_clock::now() - flatStart).count() * 1e3
+              << " ms for " << flattened.length() << " bytes" << std::endl;
+
+    // Interned identifiers: pointer comparison and cached hashes
+    StringPool& pool = StringPool::global();
+    std::vector<String> identifiers;
+    for (int i = 0; i < 4000; ++i) identifiers.push_back(String::concat("service.request.field_", std::to_string(i).c_str()));
+    std::vector<StringPool::Symbol> symbols;
+    for (const String& id : identifiers) symbols.push_back(pool.intern(id));
+    std::cout << "Interned " << pool.size() << " identifiers; intern(\"service.request.field_7\") == symbols[7]: "
+              << (pool.intern("service.request.field_7") == symbols[7]) << std::endl;
+
+    std::unordered_map<String, int> byString;
+    std::unordered_map<StringPool::Symbol, int> bySymbol;
+    for (size_t i = 0; i < identifiers.size(); ++i) {
+        byString[identifiers[i]] = static_cast<int>(i);
+        bySymbol[symbols[i]] = static_cast<int>(i);
+    }
+    const size_t lookups = 4000000;
+    long long checksum = 0;
+    auto lookupStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; ++i) checksum += byString.find(identifiers[(i * 7) % identifiers.size()])->second;
+    double stringSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - lookupStart).count();
+    lookupStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; ++i) checksum += bySymbol.find(symbols[(i * 7) % symbols.size()])->second;
+    double symbolSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - lookupStart).count();
+    std::cout << "Map lookups: String keys " << lookups / stringSeconds / 1e6 << " M/s, Symbol keys "
+              << lookups / symbolSeconds / 1e6 << " M/s (checksum " << checksum << ")" << std::endl;
+
+    // Request-scoped allocation: one arena per thread, released after every request
+    auto serveRequests = [](size_t requests, bool useArena) {
+        StringArena arena;
+        size_t checksum = 0;
+        for (size_t r = 0; r < requests; ++r) {
+            {
+                std::optional<String::ResourceScope> scope;
+                if (useArena) scope.emplace(&arena);
+                String line = String::concat("GET /api/v1/users/", std::to_string(r).c_str(),
+                                             "/profile?fields=name,email,created_at,last_login HTTP/1.1");
+                String path = line.substr(4, line.find(" HTTP") - 4);
+                for (const String& piece : path.split('/')) checksum += piece.toUpperCase().length();
+                checksum += line.toLowerCase().length();
+            }
+            arena.release();
+        }
+        return checksum;
+    };
+    std::cout << "Requests/s by thread count (global heap vs arena):" << std::endl;
+    for (unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u}) {
+        double rates[2];
+        for (int useArena = 0; useArena < 2; ++useArena) {
+            const size_t perThread = 200000 / threads;
+            std::vector<std::thread> workers;
+            auto begin = std::chrono::steady_clock::now();
+            for (unsigned t = 0; t < threads; ++t) workers.emplace_back(serveRequests, perThread, useArena == 1);
+            for (std::thread& w : workers) w.join();
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            rates[useArena] = perThread * threads / secs;
+        }
+        std::cout << "  " << threads << " threads: " << rates[0] / 1e6 << " M/s vs " << rates[1] / 1e6 << " M/s" << std::endl;
+    }
+
+    // Strings that outlive a request (interned symbols, rope chunks) never use its arena
+    {
+        StringArena arena;
+        const char* name = "request.scoped.symbol.with_a_name_longer_than_the_inline_buffer";
+        StringPool::Symbol symbol;
+        Rope rope;
+        {
+            String::ResourceScope scope(&arena);
+            String text(name);
+            symbol = pool.intern(text.view());
+            rope = Rope(text.view());
+        }
+        arena.release();
+        {
+            String::ResourceScope scope(&arena);
+            String reuse(std::string(200, 'x').c_str());  // Reuses the released arena memory
+        }
+        std::cout << "Interned under a released arena: " << symbol.str() << " (intact: "
+                  << (symbol.view() == StringView(name) && rope.toString() == name) << ")" << std::endl;
+    }
+
+    // Streaming extraction: tokens of any length, getline, and whole-file ingest
+    {
+        std::string tempPath = (std::filesystem::temp_directory_path() / "string_demo.txt").string();
+        const char* path = tempPath.c_str();
+        std::FILE* out = std::fopen(path, "wb");
+        if (!out) throw std::runtime_error(std::string("Cannot create ") + path);
+        std::string longToken(5000, 'x');
+        std::fprintf(out, "short %s tail\nsecond line\n", longToken.c_str());
+        for (int i = 0; i < 200000; ++i) std::fprintf(out, "word%d value%d\n", i, i * 7);
+        std::fclose(out);
+
+        String first, second;
+        {
+            std::ifstream file(path);
+            file >> first >> second;
+        }
+        std::cout << "First token: " << first << ", second token length: " << second.length() << std::endl;
+
+        auto timed = [](const char* label, size_t bytes, auto&& body) {
+            auto begin = std::chrono::steady_clock::now();
+            size_t result = body();
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            std::cout << label << ": " << result << " in " << secs * 1e3 << " ms (" << bytes / secs / 1e9 << " GB/s)" << std::endl;
+        };
+        size_t fileBytes = String::readFile(path).length();
+        timed("Tokens via String >>", fileBytes, [&] {
+            std::ifstream file(path);
+            String token;
+            size_t count = 0;
+            while (file >> token) ++count;
+            return count;
+        });
+        timed("Tokens via std::string >>", fileBytes, [&] {
+            std::ifstream file(path);
+            std::string token;
+            size_t count = 0;
+            while (file >> token) ++count;
+            return count;
+        });
+        timed("Lines via getline", fileBytes, [&] {
+            std::ifstream file(path);
+            String line;
+            size_t count = 0;
+            while (getline(file, line)) ++count;
+            return count;
+        });
+        timed("readFile bytes", fileBytes, [&] { return String::readFile(path).length(); });
+        timed("MappedFile lines", fileBytes, [&] {
+            MappedFile file(path);
+            size_t count = 0;
+            for (StringView line : SplitRange(file.view(), '\n')) count += !line.empty();
+            return count;
+        });
+        std::remove(path);
+    }
+
+    // UTF-8: code points, sparse index, transcoding
+    String intl = "Grüße, Ελλάδα, 東京 🙂!";
+    std::cout << "'" << intl << "': " << intl.length() << " bytes, " << intl.codePointCount()
+              << " code points, valid: " << intl.isValidUtf8() << ", code points:";
+    for (char32_t cp : intl.codePoints()) std::cout << " U+" << std::hex << static_cast<uint32_t>(cp) << std::dec;
+    std::cout << std::endl;
+    std::cout << "substrCodePoints(7, 6): '" << intl.substrCodePoints(7, 6) << "', UTF-16 units: "
+              << intl.toUtf16().size() << ", round trip: " << (String::fromUtf16(intl.toUtf16()) == intl)
+              << ", invalid \\xC0\\xAF valid: " << String("a\xC0\xAF").isValidUtf8() << std::endl;
+    {
+        const char* words[] = {"Hello, world! ", "Grüße aus Köln. ", "Καλημέρα κόσμε. ", "Привет, мир. ", "東京都 ", "🙂🚀 "};
+        String ascii, mixed;
+        for (size_t i = 0; ascii.length() < (4u << 20); ++i) ascii += words[0];
+        for (size_t i = 0; mixed.length() < (4u << 20); ++i) mixed += words[i % 6];
+        auto rate = [](const char* label, const String& text, auto&& body) {
+            auto begin = std::chrono::steady_clock::now();
+            size_t result = body();
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            std::cout << "  " << label << ": " << text.length() / secs / 1e9 << " GB/s (" << result << ")" << std::endl;
+        };
+        std::cout << "UTF-8 throughput (ASCII / mixed):" << std::endl;
+        for (const String* text : {&ascii, &mixed}) {
+            rate("validate", *text, [&] { return static_cast<size_t>(text->isValidUtf8()); });
+            rate("count code points", *text, [&] { return text->codePointCount(); });
+            rate("iterate code points", *text, [&] {
+                size_t sum = 0;
+                for (char32_t cp : text->codePoints()) sum += cp;
+                return sum;
+            });
+            rate("to UTF-16", *text, [&] { return text->toUtf16().size(); });
+            rate("to UTF-32", *text, [&] { return text->toUtf32().size(); });
+            rate("build index", *text, [&] { return Utf8Index(text->view()).size(); });
+        }
+        Utf8Index index(mixed.view());
+        size_t checksum = 0, lookups = 1000000;
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookups; ++i) checksum += index.substr((i * 2654435761u) % (index.size() - 16), 16).length();
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << "  random 16-code-point substr via index: " << secs / lookups * 1e9 << " ns (" << checksum << ")" << std::endl;
+    }
+
+    // Multi-pattern matching: one Aho-Corasick pass vs one String::find pass per pattern
+    MultiSearcher keywords{"he", "she", "his", "hers"};
+    std::cout << "Keywords in 'ushers':";
+    for (const MultiSearcher::Match& m : keywords.findAll("ushers")) std::cout << " " << m.pattern << "@" << m.position;
+    std::cout << std::endl;
+    {
+        uint64_t seed = 42;
+        auto nextRandom = [&seed] {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            return seed;
+        };
+        auto randomWord = [&](size_t minLength, size_t maxLength) {
+            String word;
+            size_t n = minLength + nextRandom() % (maxLength - minLength + 1);
+            for (size_t i = 0; i < n; ++i) word.push_back(static_cast<char>('a' + nextRandom() % 26));
+            return word;
+        };
+        String text;
+        text.reserve(4u << 20);
+        while (text.length() < (4u << 20)) {
+            text += randomWord(2, 9);
+            text.push_back(' ');
+        }
+        std::cout << "Multi-pattern scan of " << (text.length() >> 20) << " MB:" << std::endl;
+        for (size_t patternCount : {10u, 100u, 10000u}) {
+            std::vector<String> patterns;
+            for (size_t i = 0; i < patternCount; ++i) patterns.push_back(randomWord(4, 8));
+            auto begin = std::chrono::steady_clock::now();
+            MultiSearcher matcher(patterns);
+            double buildSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            begin = std::chrono::steady_clock::now();
+            size_t found = matcher.count(text);
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            std::cout << "  " << patternCount << " patterns: " << found << " matches, " << text.length() / secs / 1e9
+                      << " GB/s (build " << buildSecs * 1e3 << " ms)";
+            if (patternCount <= 100) {
+                begin = std::chrono::steady_clock::now();
+                size_t naive = 0;
+                for (const String& pattern : patterns) {
+                    for (size_t pos : text.findAll(pattern)) naive += pos != String::npos;
+                }
+                secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                std::cout << ", per-pattern find: " << naive << " matches, " << text.length() / secs / 1e9 << " GB/s";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    // Throughput on a 4 MB haystack with the match at the very end
+    const size_t haySize = 4 << 20;
+    String hay;
+    hay.reserve(haySize);
+    for (size_t i = 0; hay.length() < haySize - 64; ++i) hay.push_back("abcdefghij klmnopqrstuvwxyz"[i % 27]);
+    String adversarial;
+    adversarial.reserve(haySize);
+    while (adversarial.length() < haySize - 64) adversarial.push_back('a');
+    const char* shortNeedle = "needle!";
+    const char* longNeedle = "a much longer needle that only appears once!";
+    String adversarialNeedle;
+    for (int i = 0; i < 40; ++i) adversarialNeedle.push_back('a');
+    adversarialNeedle.push_back('b');
+    hay += shortNeedle;
+    hay += longNeedle;
+    adversarial += adversarialNeedle;
+
+    auto throughput = [](const char* label, const Searcher& searcher, const String& haystack) {
+        auto begin = std::chrono::steady_clock::now();
+        size_t pos = searcher.find(haystack);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << label << ": found at " << pos << ", " << haystack.length() / secs / 1e9 << " GB/s" << std::endl;
+    };
+    throughput("Short needle", Searcher(shortNeedle), hay);
+    throughput("Long needle", Searcher(longNeedle), hay);
+    throughput("Adversarial needle", Searcher(adversarialNeedle), adversarial);
+
     return 0;
 }